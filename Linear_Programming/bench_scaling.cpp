@@ -0,0 +1,71 @@
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <cmath>
+
+#include "distribution.hpp"
+#include "pwdio.hpp"
+#include "lp_bounds.hpp"
+
+// 行缩放的效果：dataset/下的四个数据集、同一组G，用内置simplex分别关闭和打开缩放（set_lp_scaling）计算LP_bounds，
+// 比较单纯形迭代次数、耗时和结果是否一致（容差内）
+// 每个数据集先用一个G预热一次，bpdf表等只算一次的部分不计入两边的耗时
+// 用法: LPScaleBench [fast|normal|slow] [dataset目录]
+
+int main(int argc, char** argv) {
+
+    std::string preset = (argc > 1) ? argv[1] : "fast";
+    std::string dir = (argc > 2) ? argv[2] : "./dataset";
+    std::vector<std::string> datasets = {"000webhost", "linkedin", "rockyou", "yahoo"};
+
+    std::vector<int64_t> G_list = {1, 1000, 1000000, 100000000, 10000000000};
+    double err = 0.01;
+    double tolerance = 1e-8;
+
+    std::cout << std::setw(12) << "dataset" << std::setw(10) << "scaling" << std::setw(14) << "iterations"
+              << std::setw(10) << "sec" << std::setw(12) << "|diff|" << std::endl;
+
+    bool all_match = true;
+    for (auto& name:datasets) {
+        dist_t dist;
+        std::string file_path = dir + "/" + name + "_freqcount.txt";
+        if (!read_file(dist, file_path, "freqcount")) {
+            std::cerr << "[Error] Failed to read file " << file_path << "! Check path." << std::endl;
+            return 1;
+        }
+        set_solver(dist, "simplex");
+        set_cache_dir(dist, "");
+        LP_bounds(dist, G_list[0], err, preset);
+
+        std::vector<double> ref_lb, ref_ub;
+        for (int scaling=0; scaling<=1; ++scaling) {
+            set_lp_scaling(dist, scaling);
+            reset_lp_sweep_stats();
+            auto t0 = std::chrono::high_resolution_clock::now();
+            auto [lb, ub] = LP_bounds(dist, G_list, err, preset);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            std::chrono::duration<double> elapsed = t1 - t0;
+
+            double diff = 0.0;
+            if (scaling == 0) {
+                ref_lb = lb;
+                ref_ub = ub;
+            }
+            for (size_t g=0; g<G_list.size() && !lb.empty(); ++g) {
+                diff = std::max(diff, std::max(fabs(lb[g] - ref_lb[g]), fabs(ub[g] - ref_ub[g])));
+            }
+            if (!(diff <= tolerance)) {
+                all_match = false;
+            }
+            std::cout << std::setw(12) << name << std::setw(10) << (scaling ? "rows" : "off") << std::setw(14) << get_lp_sweep_stats().iterations
+                      << std::setw(10) << std::fixed << std::setprecision(3) << elapsed.count() << std::defaultfloat
+                      << std::setw(12) << std::setprecision(3) << diff << std::endl;
+        }
+    }
+
+    std::cout << (all_match ? "[Info] All bounds agree within " : "[Warning] Some bounds differ by more than ") << tolerance << std::endl;
+    return all_match ? 0 : 2;
+}
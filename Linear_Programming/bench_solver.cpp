@@ -0,0 +1,81 @@
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <cmath>
+
+#include "distribution.hpp"
+#include "pwdio.hpp"
+#include "lp_bounds.hpp"
+#include "lp_backend.hpp"
+#include "thread_budget.hpp"
+
+// 求解器对比：同一数据集、同一组G，分别用每个可用的求解器（Gurobi、内置simplex）计算LP_LB/LP_UB，
+// 比较结果是否一致（容差内）以及耗时
+// 还没有在装了Gurobi的机器上跑过，内置simplex相对Gurobi的速度没有实测数据
+// 用法: LPBench [freqcount文件] [fast|normal|slow]
+
+double run_bound(dist_t& dist, std::string preset, bool upper, int64_t G, double err) {
+    if (preset == "slow") {
+        return upper ? LP_UB_slow(dist, G, err) : LP_LB_slow(dist, G, err);
+    }
+    if (preset == "normal") {
+        return upper ? LP_UB_normal(dist, G, err) : LP_LB_normal(dist, G, err);
+    }
+    return upper ? LP_UB_fast(dist, G, err) : LP_LB_fast(dist, G, err);
+}
+
+int main(int argc, char** argv) {
+
+    std::string file_path = (argc > 1) ? argv[1] : "./dataset/000webhost_freqcount.txt";
+    std::string preset = (argc > 2) ? argv[2] : "fast";
+
+    dist_t dist;
+    std::cout << "[Info] Reading file: " << file_path << " ..." << std::endl;
+    if (!read_file(dist, file_path, "freqcount")) {
+        std::cerr << "[Error] Failed to read file! Check path." << std::endl;
+        return 1;
+    }
+    std::cout << "[Info] File read successfully. N = " << dist.N << "; preset = " << preset << std::endl;
+
+    std::vector<int64_t> G_list = {1, 1000, 1000000, 100000000};
+    std::vector<std::string> solvers = available_lp_backends();
+    double err = 0.01;
+    double tolerance = 1e-6;
+
+    std::cout << std::setw(12) << "G" << std::setw(6) << "bound";
+    for (auto& s:solvers) {
+        std::cout << std::setw(16) << s << std::setw(10) << "sec";
+    }
+    std::cout << std::setw(12) << "|diff|" << std::endl;
+
+    bool all_match = true;
+    for (auto G:G_list) {
+        for (int upper=0; upper<=1; ++upper) {
+            std::vector<double> values;
+            std::cout << std::setw(12) << G << std::setw(6) << (upper ? "UB" : "LB");
+            for (auto& s:solvers) {
+                set_solver(dist, s);
+                auto start_time = std::chrono::high_resolution_clock::now();
+                double v = run_bound(dist, preset, upper, G, err);
+                auto end_time = std::chrono::high_resolution_clock::now();
+                std::chrono::duration<double> elapsed = end_time - start_time;
+                values.push_back(v);
+                std::cout << std::setw(16) << std::setprecision(10) << v
+                          << std::setw(10) << std::fixed << std::setprecision(3) << elapsed.count() << std::defaultfloat;
+            }
+            double diff = fabs(values.front() - values.back());
+            if (!(diff <= tolerance)) {
+                all_match = false;
+            }
+            std::cout << std::setw(12) << std::setprecision(3) << diff << std::endl;
+        }
+    }
+
+    print_lp_sweep_stats();
+    print_thread_report();
+    std::cout << (all_match ? "[Info] All bounds agree within " : "[Warning] Some bounds differ by more than ") << tolerance << std::endl;
+    return all_match ? 0 : 2;
+}
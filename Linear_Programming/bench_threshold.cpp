@@ -0,0 +1,72 @@
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iomanip>
+#include <cmath>
+
+#include "distribution.hpp"
+#include "pwdio.hpp"
+#include "lp_bounds.hpp"
+
+// 阈值形式的验证：dataset/下的四个数据集、同一组G，比较LP_LB/LP_UB的idx扫描与LP_LB_threshold/LP_UB_threshold的结果（容差内）以及耗时
+// 用法: LPThresholdBench [fast|normal|slow] [dataset目录]
+
+std::vector<double> run_sweep(dist_t& dist, std::string preset, bool upper, std::vector<int64_t>& Gs, double err) {
+    if (preset == "slow") {
+        return upper ? LP_UB_slow(dist, Gs, err) : LP_LB_slow(dist, Gs, err);
+    }
+    if (preset == "normal") {
+        return upper ? LP_UB_normal(dist, Gs, err) : LP_LB_normal(dist, Gs, err);
+    }
+    return upper ? LP_UB_fast(dist, Gs, err) : LP_LB_fast(dist, Gs, err);
+}
+
+int main(int argc, char** argv) {
+
+    std::string preset = (argc > 1) ? argv[1] : "fast";
+    std::string dir = (argc > 2) ? argv[2] : "./dataset";
+    std::vector<std::string> datasets = {"000webhost", "linkedin", "rockyou", "yahoo"};
+
+    std::vector<int64_t> G_list = {1, 1000, 1000000, 100000000, 10000000000};
+    double err = 0.01;
+    double tolerance = 1e-8;
+
+    bool all_match = true;
+    for (auto& name:datasets) {
+        dist_t dist;
+        std::string file_path = dir + "/" + name + "_freqcount.txt";
+        if (!read_file(dist, file_path, "freqcount")) {
+            std::cerr << "[Error] Failed to read file " << file_path << "! Check path." << std::endl;
+            return 1;
+        }
+        std::cout << "[Info] " << name << ": N = " << dist.N << "; preset = " << preset << std::endl;
+        std::cout << std::setw(14) << "G" << std::setw(6) << "bound" << std::setw(18) << "sweep" << std::setw(18) << "threshold"
+                  << std::setw(12) << "|diff|" << std::endl;
+
+        for (int upper=0; upper<=1; ++upper) {
+            auto t0 = std::chrono::high_resolution_clock::now();
+            std::vector<double> sweep = run_sweep(dist, preset, upper, G_list, err);
+            auto t1 = std::chrono::high_resolution_clock::now();
+            std::vector<double> threshold = upper ? LP_UB_threshold(dist, G_list, err, preset) : LP_LB_threshold(dist, G_list, err, preset);
+            auto t2 = std::chrono::high_resolution_clock::now();
+
+            for (size_t g=0; g<G_list.size(); ++g) {
+                double diff = fabs(sweep[g] - threshold[g]);
+                if (!(diff <= tolerance)) {
+                    all_match = false;
+                }
+                std::cout << std::setw(14) << G_list[g] << std::setw(6) << (upper ? "UB" : "LB")
+                          << std::setw(18) << std::setprecision(12) << sweep[g] << std::setw(18) << threshold[g]
+                          << std::setw(12) << std::setprecision(3) << diff << std::endl;
+            }
+            std::chrono::duration<double> sweep_sec = t1 - t0, threshold_sec = t2 - t1;
+            std::cout << std::setw(20) << (upper ? "UB sec" : "LB sec") << std::fixed << std::setprecision(3)
+                      << std::setw(18) << sweep_sec.count() << std::setw(18) << threshold_sec.count() << std::defaultfloat << std::endl;
+        }
+    }
+
+    std::cout << (all_match ? "[Info] All bounds agree within " : "[Warning] Some bounds differ by more than ") << tolerance << std::endl;
+    return all_match ? 0 : 2;
+}
@@ -0,0 +1,59 @@
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <iomanip>
+
+#include "distribution.hpp"
+#include "pwdio.hpp"
+#include "lp_bounds.hpp"
+
+// LP参数校准：在一个数据集上从preset出发搜索xhats和errs（LP规模不变），使一组G上的平均UB - LB最小，
+// 结果写入参数文件，之后load_lp_params读入，用preset "calibrated"求界
+// 用法: LPCalibrate [freqcount文件] [fast|normal|slow] [输出文件]
+
+int main(int argc, char** argv) {
+
+    std::string file_path = (argc > 1) ? argv[1] : "./dataset/000webhost_freqcount.txt";
+    std::string preset = (argc > 2) ? argv[2] : "slow";
+    std::string out_path = (argc > 3) ? argv[3] : file_path + ".lpparams";
+
+    dist_t dist;
+    std::cout << "[Info] Reading file: " << file_path << " ..." << std::endl;
+    if (!read_file(dist, file_path, "freqcount")) {
+        std::cerr << "[Error] Failed to read file! Check path." << std::endl;
+        return 1;
+    }
+    std::cout << "[Info] File read successfully. N = " << dist.N << "; preset = " << preset << std::endl;
+
+    std::vector<int64_t> G_list = {1, 100, 10000, 1000000, 100000000};
+    double err = 0.01;
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+    double gap = LP_calibrate(dist, G_list, err, preset);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end_time - start_time;
+    if (gap < 0) {
+        std::cerr << "[Error] Calibration failed." << std::endl;
+        return 1;
+    }
+
+    auto [lb0, ub0] = LP_bounds(dist, G_list, err, preset);
+    auto [lb1, ub1] = LP_bounds(dist, G_list, err, "calibrated");
+    std::cout << std::setw(12) << "G" << std::setw(16) << preset + " LB" << std::setw(16) << preset + " UB"
+              << std::setw(16) << "calibrated LB" << std::setw(16) << "calibrated UB" << std::endl;
+    for (size_t g=0; g<G_list.size(); ++g) {
+        std::cout << std::setw(12) << G_list[g] << std::setprecision(8)
+                  << std::setw(16) << lb0[g] << std::setw(16) << ub0[g]
+                  << std::setw(16) << lb1[g] << std::setw(16) << ub1[g] << std::endl;
+    }
+
+    std::cout << std::setprecision(6) << "[Info] Mean gap " << gap << " after " << std::fixed << std::setprecision(1)
+              << elapsed.count() << " s" << std::defaultfloat << std::endl;
+    if (!save_lp_params(dist, out_path)) {
+        return 1;
+    }
+    std::cout << "[Info] Parameters written to " << out_path << std::endl;
+    return 0;
+}
@@ -8,6 +8,8 @@
 #include "distribution.hpp"
 #include "pwdio.hpp"
 #include "lp_bounds.hpp"
+#include "lp_env.hpp"
+#include "profiler.hpp"
 
 // 辅助函数：提取文件名
 std::string get_filename_stem(const std::string& path) {
@@ -22,7 +24,7 @@ int main() {
 
     auto start_time = std::chrono::high_resolution_clock::now();
 
-    std::cout << "=== Program Started (Single Threaded) ===" << std::endl;
+    std::cout << "=== Program Started ===" << std::endl;
 
 
     std::string file_path = "./dataset/000webhost_freqcount.txt";
@@ -47,30 +49,23 @@ int main() {
 
     std::cout << "Starting calculation for " << G_list.size() << " points..." << std::endl;
 
-    // 3. 循环计算 
-    for (int i = 0; i < (int)G_list.size(); ++i) {
-        int64_t current_G = G_list[i];
-
-        std::cout << "Processing G = " << current_G << " ..." << std::endl;
-
-        try {
-            // 计算 LB
-            double lb = LP_LB_slow(dist, current_G, err);
-            // 计算 UB
-            double ub = LP_UB_slow(dist, current_G, err);
-
-            // 存储结果
-            results_lb[i] = lb;
-            results_ub[i] = ub;
-
-            std::cout << "[DONE] G = " << current_G 
-                      << " -> LB: " << lb << ", UB: " << ub << std::endl;
+    // 3. 整条曲线一次求解：所有G作为参数族共用一次idx扫描，相邻G之间热启动；LB和UB共用准备工作、并发扫描
+    try {
+        auto [lbs, ubs] = LP_bounds(dist, G_list, err, "slow");
+        if (lbs.size() == G_list.size() && ubs.size() == G_list.size()) {
+            results_lb = lbs;
+            results_ub = ubs;
+        }
 
-        } catch (std::exception& e) {
-            std::cerr << "\n[ERROR] Failed at G=" << current_G << ": " << e.what() << std::endl;
-        } catch (...) {
-            std::cerr << "\n[ERROR] Crashed at G=" << current_G << "!" << std::endl;
+        for (int i = 0; i < (int)G_list.size(); ++i) {
+            std::cout << "[DONE] G = " << G_list[i]
+                      << " -> LB: " << results_lb[i] << ", UB: " << results_ub[i] << std::endl;
         }
+
+    } catch (std::exception& e) {
+        std::cerr << "\n[ERROR] Failed: " << e.what() << std::endl;
+    } catch (...) {
+        std::cerr << "\n[ERROR] Crashed!" << std::endl;
     }
 
     std::cout << "All calculations finished. Appending to files..." << std::endl;
@@ -92,6 +87,10 @@ int main() {
         std::cerr << "[Error] Could not open output files for writing." << std::endl;
     }
 
+    print_env_pool_stats();
+    print_lp_sweep_stats();
+    print_profile(); // LP_PROFILE=<前缀> 时打开，另写出 <前缀>.json 和 <前缀>.trace.json
+
     auto end_time = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed = end_time - start_time;
 
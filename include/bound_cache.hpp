@@ -0,0 +1,36 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "distribution.hpp"
+
+/*
+磁盘上的界缓存：LP的界只由数据集和参数决定，同一个数据集、同一组G重复运行（崩溃后重跑、加G点、重画图）时直接读出
+  键为 dist.freqcount 的指纹 + 界的种类 + (G, q, iprime, errs, xhats)，浮点数按十六进制写出，逐位比较
+  每个键一个文件：<目录>/<指纹>/<键的哈希>，内容为键和值，读出时核对键，哈希冲突当作未命中
+  写入先写到同目录下的临时文件再rename，rename是原子的，多个进程共用一个目录时读到的总是完整的文件
+  目录由dist.cache_dir决定："auto"（默认）取环境变量LP_CACHE_DIR，没有设置时不使用缓存；""不使用；其他为目录
+  只缓存求出来的界和不可行（-2），求解器出错等不缓存
+*/
+struct bound_cache_stats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+  int64_t stored = 0;
+};
+
+bool bound_cache_enabled(dist_t&);
+std::string bound_cache_key(dist_t&, std::string kind, int64_t G, double q, int64_t iprime, const std::vector<double>& errs, const std::vector<double>& xhats);
+bool bound_cache_lookup(dist_t&, const std::string& key, double& value);
+void bound_cache_store(dist_t&, const std::string& key, double value);
+
+// 也用于sweep_checkpoint：数据集指纹、字符串哈希、先写临时文件再rename的原子写入
+uint64_t fingerprint(dist_t&);
+uint64_t hash_string(const std::string&);
+bool write_file_atomic(dist_t&, std::string filename, const std::string& content);
+
+bound_cache_stats get_bound_cache_stats();
+void reset_bound_cache_stats();
+void print_bound_cache_stats();
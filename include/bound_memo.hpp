@@ -0,0 +1,20 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+
+#include "distribution.hpp"
+
+/*
+进程内的界备忘录：同一个进程里对同一个数据集重复查询同一个界（best_LB、best_UB和bound()各自会调用binom、LP）时直接返回
+  存在dist.memo里，键为 (界的名称, G, err, preset)，err按十六进制写出，逐位比较
+  条目数超过dist.memo.capacity时按最近使用时间淘汰最旧的四分之一（LRU），capacity为0时不使用
+  只记录求出来的界和不可行（-2），参数不合法、求解器出错等不记录
+  dist.freqcount重新读入、重新划分（partition、pre_partition，binom LB依赖划分）、换求解器、校准参数改变时清空；不是线程安全的，和dist_t的其他惰性字段一样只在串行代码里使用
+*/
+bool memo_lookup(dist_t&, std::string name, int64_t G, double err, std::string preset, double& value);
+void memo_store(dist_t&, std::string name, int64_t G, double err, std::string preset, double value);
+void clear_memo(dist_t&);
+void set_memo_capacity(dist_t&, int64_t);
+void print_memo_stats(dist_t&);
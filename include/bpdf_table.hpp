@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+#include <memory>
+
+/*
+bpdf_table: 网格上二项分布概率的缓存 vals[i*l + j] = bpdf(i, N, mesh[j]), 0 <= i <= iprime
+  约束(2)在每个idx、LB/UB、每个G上都用同一批系数，只算一次，之后只读共享（包括多线程）
+*/
+struct bpdf_table {
+  int64_t N = 0;
+  int64_t iprime = -1;
+  std::vector<double> mesh;
+  std::vector<double> vals;
+
+  const double* row(int64_t i) const { return &vals[i * mesh.size()]; }
+};
+
+std::shared_ptr<const bpdf_table> get_bpdf_table(int64_t N, const std::vector<double>& mesh, int64_t iprime);
+void clear_bpdf_tables();
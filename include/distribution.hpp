@@ -1,9 +1,20 @@
 #pragma once
 
+#include <stdint.h>
+
 #include <vector>
 #include <string>
 #include <unordered_map>
 
+// in-memory memo of bound results, see bound_memo.hpp
+struct bound_memo_t {
+  int64_t capacity = 4096; // entries, 0 disables the memo
+  uint64_t tick = 0;
+  std::unordered_map<std::string, std::pair<double, uint64_t>> entries; // key -> (value, last use)
+  int64_t hits = 0;
+  int64_t misses = 0;
+};
+
 struct dist_t {
   std::string filename;
   std::string filetype;
@@ -22,7 +33,27 @@ struct dist_t {
   int64_t distinct = 0;
   int64_t distinct_D1 = 0;
 
+  std::vector<double> good_turing; // good_turing[k] = k*f_k/(N-k+1), dense, filled lazily by good_turing_estimates
+
   bool verbose = true;
+  std::string solver = "auto"; // LP backend used by LP_LB/LP_UB: "auto", "gurobi" or "simplex", see lp_backend.hpp
+  int threads = 0; // cores shared by the parallel loops and the LP solver, 0 uses omp_get_max_threads(), see thread_budget.hpp
+
+  // parameters of the "calibrated" LP preset, set by LP_calibrate or load_lp_params, see lp_bounds.hpp
+  double lp_q = 0; // 0 until calibrated
+  int64_t lp_iprime = 0;
+  std::vector<double> lp_xhats; // in units of 1/N
+  std::vector<double> lp_errs; // in units of err
+
+  bool certify = false; // LP values replaced by rounding-safe dual bounds, see LP_sweep::certified_bound
+  double lp_tolerance = 0; // feasibility/optimality tolerance of the LP backend, 0 keeps the backend's default
+  bool lp_scaling = true; // row equilibration in the LP backend, see simplex_lp::scale_model
+
+  std::string cache_dir = "auto"; // on-disk LP bound cache: "auto" (LP_CACHE_DIR if set), "" (off) or a directory, see bound_cache.hpp
+  uint64_t fingerprint = 0; // hash of freqcount keying the cache, 0 until computed
+  std::string checkpoint_dir = "auto"; // idx sweep checkpoints: "auto" (LP_CHECKPOINT_DIR if set), "" (off) or a directory, see sweep_checkpoint.hpp
+  double checkpoint_interval = 60; // seconds between checkpoints of one sweep block
+  bound_memo_t memo; // cleared when freqcount, the partition, the solver or the calibrated parameters change
 };
 
 void print1(dist_t&);
@@ -31,8 +62,15 @@ void print3(dist_t&);
 void print4(dist_t&);
 
 void set_verbose(dist_t&, bool);
+void set_solver(dist_t&, std::string);
+void set_threads(dist_t&, int);
+void set_cache_dir(dist_t&, std::string);
+void set_certify(dist_t&, bool, double tolerance = 0);
+void set_lp_scaling(dist_t&, bool);
+void set_checkpoint(dist_t&, std::string, double interval = 60);
 
 int64_t most_frequent(dist_t&, int64_t);
+const std::vector<double>& good_turing_estimates(dist_t&, int64_t);
 
 void partition_small_d(dist_t&, int64_t);
 void partition_large_d(dist_t&, int64_t);
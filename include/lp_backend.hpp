@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <stdexcept>
+
+/*
+LP求解后端接口：LP_sweep只通过这个接口建模和求解
+  变量: lb <= x_j <= ub，目标系数obj
+  约束: lo <= sum_j a_rj x_j <= hi，单边约束用 -inf/inf 表示
+  cutoff: 只关心比cutoff更好的解，能证明最优值不会更好时提前返回LP_CUTOFF
+  tolerance: 原始可行性和最优性（检验数）的容差，放宽后更快，结果可以用对偶证书补成严格的界（见LP_sweep::certified_bound）
+  scaling: 求解前对行做缩放（均衡），接口上的系数、解和对偶都是原模型的
+  threads: 一次求解可以用的线程数，由线程预算分配（见thread_budget.hpp），内置simplex是单线程的
+*/
+
+enum lp_status {
+  LP_OPTIMAL = 0,
+  LP_INFEASIBLE = 1,
+  LP_OTHER = 2, // unbounded, iteration limit, numerical trouble, ...
+  LP_CUTOFF = 3, // stopped early, the optimum provably can't beat the cutoff
+};
+
+// thrown by backends, code is the solver's own error code
+struct lp_error : public std::runtime_error {
+  int code;
+  lp_error(int code, const std::string& message) : std::runtime_error(message), code(code) {}
+};
+
+class lp_backend {
+ public:
+  virtual ~lp_backend() {}
+
+  virtual int add_var(double lb, double ub, double obj) = 0;
+  virtual int add_row(double lo, double hi, const std::vector<int>& vars, const std::vector<double>& vals) = 0;
+  virtual void set_coeff(int row, int var, double val) = 0;
+  virtual void set_obj(int var, double val) = 0;
+  virtual void set_row_bounds(int row, double lo, double hi) = 0;
+  virtual void set_maximize(bool maximize) = 0;
+  virtual void set_cutoff(double cutoff) = 0; // min: give up once the optimum is proven >= cutoff (max: <=), +-inf disables
+  virtual void set_tolerance(double tol) = 0; // primal feasibility and optimality tolerance, looser is faster
+  virtual void set_scaling(bool on) = 0; // equilibrate rows before solving, on by default
+  virtual void set_threads(int threads) = 0; // threads one solve may use, see thread_budget.hpp
+
+  virtual int solve() = 0; // lp_status
+  virtual double objective() = 0;
+  virtual double value(int var) = 0; // primal value of var in the last optimal solution
+  virtual double reduced_cost(int var) = 0; // obj_j - y^T a_j of the last optimal solution
+  virtual double dual(int row) = 0; // y_row of the last optimal solution; after LP_CUTOFF the duals that proved it, or lp_error if the backend has none
+  virtual void reset() = 0; // forget the basis, the next solve starts cold
+  virtual int64_t iterations() = 0; // simplex iterations of the last solve
+};
+
+std::unique_ptr<lp_backend> make_gurobi_backend();
+std::unique_ptr<lp_backend> make_simplex_backend();
+std::unique_ptr<lp_backend> make_lp_backend(const std::string& name); // "auto", "gurobi" or "simplex"
+std::vector<std::string> available_lp_backends();
@@ -2,9 +2,46 @@
 
 #include <vector>
 #include <map>
+#include <string>
+#include <utility>
 
 #include "distribution.hpp"
 
+/*
+LP_LB/LP_UB的idx扫描统计，自上次reset起累计，剪枝方式见lp_bounds.cpp中LP_sweep_all的说明
+*/
+struct lp_sweep_stats {
+  int64_t sweeps = 0;        // 扫描次数，每次LP_LB/LP_UB一次
+  int64_t idx_total = 0;     // 扫描覆盖的idx数，每次l+1个
+  int64_t solved = 0;        // 求解的LP数，含可行区间二分的可行性LP
+  int64_t infeasible = 0;    // 其中不可行的
+  int64_t cutoff_pruned = 0; // 其中因cutoff提前停止的
+  int64_t range_pruned = 0;  // 落在可行区间外或被目标下界排除、没有求解的idx
+  int64_t columns = 0;       // 各次扫描的网格列数
+  int64_t aggregated = 0;    // 其中因列聚合不进模型的
+  int64_t iterations = 0;    // 所有LP的单纯形迭代次数之和
+};
+
+/*
+LP_bounds_progressive的结果，lb/ub/preset依次对应每个G，preset为该G最后求解的精度模式（fast、normal或slow）
+*/
+struct lp_progressive_result {
+  std::vector<double> lb;
+  std::vector<double> ub;
+  std::vector<std::string> preset;
+};
+
+/*
+LP_LB_anytime/LP_UB_anytime的结果，依次对应每个G
+  bound为合法的界（-2不可行，-3求解器出错），完整求解的值在bound和limit之间：LB时 bound <= 值 <= limit，UB时 limit <= 值 <= bound
+  complete表示在时限内求解完成，这时bound与LP_LB_threshold/LP_UB_threshold相同
+*/
+struct lp_anytime_result {
+  std::vector<double> bound;
+  std::vector<double> limit;
+  std::vector<bool> complete;
+};
+
 double LP_lower(dist_t&, int64_t, std::vector<double>&, double, int64_t, int64_t, std::vector<double>&, std::vector<double>&, std::vector<double>&);
 double LP_upper(dist_t&, int64_t, std::vector<double>&, double, int64_t, int64_t, std::vector<double>&, std::vector<double>&, std::vector<double>&);
 double LP_LB(dist_t&, int64_t, double, int64_t, std::vector<double>, std::vector<double>);
@@ -17,3 +54,56 @@ double LP_LB_slow(dist_t&, int64_t, double);
 double LP_UB_slow(dist_t&, int64_t, double);
 double LP_LB(dist_t&, int64_t, double); 
 double LP_UB(dist_t&, int64_t, double); 
+
+// 整条曲线：Gs一起求解，结果依次对应每个G
+std::vector<double> LP_LB(dist_t&, std::vector<int64_t>, double, int64_t, std::vector<double>, std::vector<double>);
+std::vector<double> LP_UB(dist_t&, std::vector<int64_t>, double, int64_t, std::vector<double>, std::vector<double>);
+std::vector<double> LP_LB_fast(dist_t&, std::vector<int64_t>, double);
+std::vector<double> LP_UB_fast(dist_t&, std::vector<int64_t>, double);
+std::vector<double> LP_LB_normal(dist_t&, std::vector<int64_t>, double);
+std::vector<double> LP_UB_normal(dist_t&, std::vector<int64_t>, double);
+std::vector<double> LP_LB_slow(dist_t&, std::vector<int64_t>, double);
+std::vector<double> LP_UB_slow(dist_t&, std::vector<int64_t>, double);
+std::vector<double> LP_LB(dist_t&, std::vector<int64_t>, double);
+std::vector<double> LP_UB(dist_t&, std::vector<int64_t>, double);
+
+// 自适应网格：粗网格q_coarse上求解，只在最优解附近加密到q_fine，默认参数与slow相同；结果与整批Gs有关，不经过磁盘缓存（bound_cache.hpp）
+double LP_LB_adaptive(dist_t&, int64_t, double, double, int64_t, std::vector<double>, std::vector<double>);
+double LP_UB_adaptive(dist_t&, int64_t, double, double, int64_t, std::vector<double>, std::vector<double>);
+double LP_LB_adaptive(dist_t&, int64_t, double);
+double LP_UB_adaptive(dist_t&, int64_t, double);
+std::vector<double> LP_LB_adaptive(dist_t&, std::vector<int64_t>, double);
+std::vector<double> LP_UB_adaptive(dist_t&, std::vector<int64_t>, double);
+
+// 阈值形式：把idx的选择换成攻击者的概率阈值，LB分支定界、UB凸的一维极小化，结果与上面的扫描相同；preset为fast、normal、slow或calibrated（见LP_calibrate）
+double LP_LB_threshold(dist_t&, int64_t, double, int64_t, std::vector<double>, std::vector<double>);
+double LP_UB_threshold(dist_t&, int64_t, double, int64_t, std::vector<double>, std::vector<double>);
+std::vector<double> LP_LB_threshold(dist_t&, std::vector<int64_t>, double, int64_t, std::vector<double>, std::vector<double>);
+std::vector<double> LP_UB_threshold(dist_t&, std::vector<int64_t>, double, int64_t, std::vector<double>, std::vector<double>);
+double LP_LB_threshold(dist_t&, int64_t, double, std::string preset = "normal");
+double LP_UB_threshold(dist_t&, int64_t, double, std::string preset = "normal");
+std::vector<double> LP_LB_threshold(dist_t&, std::vector<int64_t>, double, std::string preset = "normal");
+std::vector<double> LP_UB_threshold(dist_t&, std::vector<int64_t>, double, std::string preset = "normal");
+// 有时限的阈值形式：seconds秒后停下，返回此刻合法的界和完整求解的值所在的范围，参数不合法时返回空的结果
+lp_anytime_result LP_LB_anytime(dist_t&, std::vector<int64_t>, double, double seconds, std::string preset = "normal");
+lp_anytime_result LP_UB_anytime(dist_t&, std::vector<int64_t>, double, double seconds, std::string preset = "normal");
+
+// LB和UB一起：(LB, UB)，共用所有与G有关的准备工作，两个扫描并发进行；preset为fast、normal、slow或calibrated
+std::pair<double, double> LP_bounds(dist_t&, int64_t, double, int64_t, std::vector<double>, std::vector<double>);
+std::pair<std::vector<double>, std::vector<double>> LP_bounds(dist_t&, std::vector<int64_t>, double, int64_t, std::vector<double>, std::vector<double>);
+std::pair<double, double> LP_bounds(dist_t&, int64_t, double, std::string preset = "normal");
+std::pair<std::vector<double>, std::vector<double>> LP_bounds(dist_t&, std::vector<int64_t>, double, std::string preset = "normal");
+// 多个置信水平：errs中每个err一组(LB, UB)，所有err共用一个模型，err之间只改约束(2)的右端项
+std::vector<std::pair<std::vector<double>, std::vector<double>>> LP_bounds(dist_t&, std::vector<int64_t>, std::vector<double> errs, std::string preset = "normal");
+
+// 逐级提高精度：fast -> normal -> slow，只对UB - LB仍超过gap的G升级，参数不合法时返回空的结果
+lp_progressive_result LP_bounds_progressive(dist_t&, std::vector<int64_t>, double, double gap);
+
+// 按数据集校准xhats和errs（q、iprime取preset的值），结果存入dist供preset "calibrated"使用，返回Gs上的平均gap
+double LP_calibrate(dist_t&, std::vector<int64_t>, double, std::string = "slow");
+bool save_lp_params(dist_t&, std::string);
+bool load_lp_params(dist_t&, std::string); // 先读入样本：xhats * q须小于它的N，errs的和不超过0.5（单位err）
+
+lp_sweep_stats get_lp_sweep_stats();
+void reset_lp_sweep_stats();
+void print_lp_sweep_stats();
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+
+#ifdef HAVE_GUROBI
+#include "gurobi_c++.h"
+#endif
+
+/*
+每个线程持有一个已启动的GRBEnv，LP_lower/LP_upper从这里取环境，
+避免每次求解都重新构造并启动环境
+*/
+struct env_pool_stats {
+  int64_t created = 0; // 新建并启动的环境数
+  int64_t reused = 0;  // 直接复用已有环境的次数
+};
+
+#ifdef HAVE_GUROBI
+GRBEnv& pooled_env();
+#endif
+env_pool_stats get_env_pool_stats();
+void reset_env_pool_stats();
+void print_env_pool_stats();
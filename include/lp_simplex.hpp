@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <vector>
+#include <limits>
+
+#include "lp_backend.hpp"
+
+/*
+simplex_lp: 针对"行很少、列很多"的LP的稠密有界原始单纯形法
+  猜测曲线LP只有 2*(iprime+1)+4 行，却有几千到上万列（网格点），
+  因此基矩阵只有 m x m (m < 20)，直接用稠密的 B^{-1}；
+  每次迭代的主要开销是对所有列定价 O(m*n)
+  每行带一个逻辑变量 s_r = a_r x，lo_r <= s_r <= hi_r，
+  第一阶段最小化不可行量之和（可以从任意基热启动），第二阶段优化原目标
+  第二阶段每次定价顺带算出当前对偶y的拉格朗日下界 sum_k min_{box} d_k x_k，
+  下界已经不比cutoff好时提前返回LP_CUTOFF
+  缩放：求解前给新的行选一个2的幂的因子R_r（见scale_model），内部存的是 R_r a_r 和 R_r lo_r、R_r hi_r，
+  之后的set_coeff等按同样的因子换算，dual返回时换算回原模型；
+  行的可行性容差和检验数的容差按原模型的单位换算，缩放只改变定价和选主元，不改变可行和最优的判定
+*/
+class simplex_lp : public lp_backend {
+ public:
+  int add_var(double lb, double ub, double obj) override;
+  int add_row(double lo, double hi, const std::vector<int>& vars, const std::vector<double>& vals) override;
+  void set_coeff(int row, int var, double val) override;
+  void set_obj(int var, double val) override;
+  void set_row_bounds(int row, double lo, double hi) override;
+  void set_maximize(bool maximize) override;
+  void set_cutoff(double cutoff) override;
+  void set_tolerance(double tol) override;
+  void set_scaling(bool on) override;
+  void set_threads(int /*threads*/) override {} // serial
+
+  int solve() override;
+  double objective() override;
+  double value(int var) override;
+  double reduced_cost(int var) override;
+  double dual(int row) override;
+  void reset() override;
+  int64_t iterations() override;
+
+ private:
+  enum var_state : signed char { BASIC, AT_LB, AT_UB, AT_ZERO };
+
+  double col(int k, int r) const; // entry r of column k, logicals are -e_r
+  double unit(int k) const;
+  double lo(int k) const;
+  double hi(int k) const;
+  double cost(int k, bool phase1) const;
+
+  void scale_model();
+  void scale_row(int r, double f);
+
+  void slack_basis();
+  void snap_nonbasic();
+  bool factor();
+  void compute_xB();
+  double infeasibility(int i) const;
+
+  int m = 0; // rows
+  int n = 0; // structural variables
+  bool maximize = false;
+  double cutoff = std::numeric_limits<double>::infinity(); // as passed to set_cutoff, infinite means none
+  double feas_tol = 1e-9; // primal feasibility
+  double opt_tol = 1e-9; // reduced costs
+
+  std::vector<double> A; // column-major, column j is A[j*m .. j*m+m)
+  std::vector<double> obj;
+  std::vector<double> var_lb, var_ub;
+  std::vector<double> row_lo, row_hi;
+
+  // scaling: stored rows are the original ones times row_scale, see scale_model
+  bool scaling = true;
+  std::vector<double> row_scale;
+  std::vector<bool> row_scaled; // the factor has been chosen, new rows get theirs at the next solve
+
+  // basis: head[i] is the variable basic in position i, variables >= n are row logicals
+  std::vector<int> head;
+  std::vector<var_state> state;
+  std::vector<double> x;
+  std::vector<double> Binv; // row-major m x m
+  bool has_basis = false;
+
+  double objval = 0.0;
+  std::vector<double> duals; // y of the last optimal basis (or of the basis that proved a cutoff), in the minimization sense
+  int64_t iters = 0;
+};
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <atomic>
+
+/*
+分阶段的性能剖析：作用域计时器（区间）和计数器，输出JSON汇总和Chrome trace-event文件（chrome://tracing或Perfetto打开）
+  prof_span span("idx solve", "idx", idx)：从构造到析构是一个区间，记下名称、线程、开始时间、时长和一个可选的数值参数
+  prof_count("simplex iterations", n)：按名称累加
+  默认关闭，关闭时一个区间只多一次原子读；enable_profiling()或环境变量LP_PROFILE=<路径前缀>打开，
+    LP_PROFILE设置时进程退出前自动写出 <前缀>.json 和 <前缀>.trace.json
+  每个线程把事件记在自己的缓冲区里；汇总（次数、总时长、自身时长、最长）不设上限，
+    逐条事件每个线程最多保留PROF_MAX_EVENTS条，多出来的只进汇总
+  名称必须是字符串字面量（只存指针），同名的区间在汇总里合并
+*/
+
+extern std::atomic<bool> profiling_on;
+
+inline bool profiling_enabled() {
+  return profiling_on.load(std::memory_order_relaxed);
+}
+
+class prof_span {
+ public:
+  explicit prof_span(const char* name, const char* arg_name = nullptr, double arg = 0.0) {
+    if (profiling_enabled()) {
+      begin(name, arg_name, arg);
+    }
+  }
+  ~prof_span() {
+    if (start >= 0) {
+      end();
+    }
+  }
+  prof_span(const prof_span&) = delete;
+  prof_span& operator=(const prof_span&) = delete;
+
+ private:
+  void begin(const char* name, const char* arg_name, double arg);
+  void end();
+
+  const char* name = nullptr;
+  const char* arg_name = nullptr;
+  double arg = 0.0;
+  int64_t start = -1; // ns since the profiler's epoch, -1 when not recorded
+};
+
+void prof_count(const char* name, int64_t n = 1);
+
+void enable_profiling(bool on = true);
+void reset_profile();
+bool write_profile_json(const std::string& filename);
+bool write_chrome_trace(const std::string& filename);
+void print_profile();
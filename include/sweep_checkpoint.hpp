@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+#include <chrono>
+
+#include "distribution.hpp"
+
+/*
+idx扫描的检查点：很慢的扫描（slow模式、大数据集，一个G要跑几个小时）中途被杀掉后，重新运行时从检查点继续
+  扫描按块并行（见LP_sweep_curve），每块按顺序求解一段idx，块的状态是下一个要求解的idx位置、
+  块内每个G的min/max、可行标志、取到最优值的idx、已求解的LP数以及当前最优值；
+  每块每隔dist.checkpoint_interval秒把自己的状态交上来，同时整个检查点写入文件（先写临时文件再rename），块结束时也交一次
+  文件为 <目录>/sweep-<键的哈希>.ckpt，键包含数据集指纹、Gs、LB/UB、eps、xhats和网格，读出时核对键和分块，不一致就从头开始
+  扫描正常结束后删除文件；求解器出错时保留，重跑时从出错前的状态继续
+  目录由dist.checkpoint_dir决定："auto"（默认）取环境变量LP_CHECKPOINT_DIR，没有设置时不使用检查点；""不使用；其他为目录
+  扫描前的可行范围二分和探测只有几十个LP，不进检查点，继续时重新求解
+*/
+struct sweep_block_state {
+  bool started = false;
+  bool done = false;
+  int64_t next = 0; // position in the block's idx list of the next idx to solve
+  bool reverse = false;
+  std::vector<double> bmin, bmax, best;
+  std::vector<int64_t> bidx, bsolved;
+  std::vector<char> bfeasible, have_best;
+};
+
+struct sweep_checkpoint {
+  std::string path;
+  std::string key;
+  int64_t n_G = 0;
+  std::vector<int64_t> block_first, block_last;
+  std::vector<sweep_block_state> blocks;
+  std::chrono::steady_clock::time_point last_write;
+};
+
+bool checkpoint_enabled(dist_t&);
+void init_checkpoint(dist_t&, sweep_checkpoint&, const std::string& key, int64_t n_G, const std::vector<int64_t>& block_first, const std::vector<int64_t>& block_last);
+bool load_checkpoint(dist_t&, sweep_checkpoint&);
+bool save_checkpoint(dist_t&, sweep_checkpoint&);
+void remove_checkpoint(dist_t&, sweep_checkpoint&);
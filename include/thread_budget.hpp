@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "distribution.hpp"
+
+/*
+线程预算：外层的并行（G、idx分块、校准的候选参数，调用方自己的数据集循环）和求解器内部的线程分同一份核
+  预算：最外层为dist.threads（0时为omp_get_max_threads()）；thread_job里为这个job分到的份额；
+    其他并行区域里（调用方自己开的、没有thread_job）为1，不再往下分
+  split_threads(dist, jobs, phase)在一个并行循环开始前调用：外层取 min(jobs, 预算) 个线程，每个job分到 预算/外层 个，
+    循环体开头用thread_job固定这个份额：job里建的LP模型按份额设求解器线程数（LP_sweep，内置simplex是单线程的，
+    只有Gurobi用得上），job里再嵌套的并行循环也只在份额里分。job数不少于预算时每个job一个线程，求解器也是单线程
+  job里的嵌套循环要求第二层活跃并行：最外层的划分在per_job > 1时把omp_get_max_active_levels()提到2，
+    thread_split析构时恢复原值，调用方自己的OpenMP代码在划分之外看到的设置不变；thread_split只能移动，不能复制
+  每次划分按 (phase, jobs, 外层, 每个job) 记在运行报告里，print_thread_report输出
+*/
+struct thread_split {
+  int outer = 1; // threads of the parallel loop
+  int per_job = 1; // threads of one job: its LP solves and nested loops
+
+  thread_split() = default;
+  thread_split(thread_split&& other) noexcept;
+  thread_split& operator=(thread_split&&) = delete;
+  thread_split(const thread_split&) = delete;
+  ~thread_split();
+
+ private:
+  friend thread_split split_threads(dist_t&, int64_t, const std::string&);
+  int saved_levels = -1; // max active levels to restore, -1 when split_threads left them alone
+};
+
+struct thread_report_entry {
+  std::string phase;
+  int64_t jobs = 0;
+  int budget = 0;
+  int outer = 1;
+  int per_job = 1;
+  int64_t count = 0; // loops that used this split
+};
+
+// fixes the calling thread's budget to split.per_job for the lifetime of the object, one per job of a split loop
+class thread_job {
+ public:
+  explicit thread_job(const thread_split& split);
+  ~thread_job();
+  thread_job(const thread_job&) = delete;
+  thread_job& operator=(const thread_job&) = delete;
+
+ private:
+  int saved;
+};
+
+int thread_budget(dist_t&);
+thread_split split_threads(dist_t&, int64_t jobs, const std::string& phase);
+std::vector<thread_report_entry> get_thread_report();
+void reset_thread_report();
+void print_thread_report();
@@ -0,0 +1,162 @@
+#include "bound_cache.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <random>
+#include <filesystem>
+
+#include "profiler.hpp"
+
+static std::atomic<int64_t> cache_hits(0);
+static std::atomic<int64_t> cache_misses(0);
+static std::atomic<int64_t> cache_stored(0);
+
+// FNV-1a
+static uint64_t fnv1a(const void* data, size_t size, uint64_t h = 14695981039346656037ULL) {
+  const unsigned char* p = (const unsigned char*) data;
+  for (size_t i=0; i<size; ++i) {
+    h ^= p[i];
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+static std::string hex64(uint64_t x) {
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016llx", (unsigned long long) x);
+  return buf;
+}
+
+static std::string hexfloat(double x) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%a", x);
+  return buf;
+}
+
+static std::string cache_dir(dist_t& dist) {
+  if (dist.cache_dir != "auto") {
+    return dist.cache_dir;
+  }
+  const char* env = std::getenv("LP_CACHE_DIR");
+  return env ? env : "";
+}
+
+// dist.freqcount的指纹，第一次用到时计算，parse_freqcount换数据时清零
+uint64_t fingerprint(dist_t& dist) {
+  if (dist.fingerprint == 0) {
+    uint64_t h = fnv1a(dist.freqcount.data(), dist.freqcount.size() * sizeof(dist.freqcount[0]));
+    dist.fingerprint = (h == 0) ? 1 : h;
+  }
+  return dist.fingerprint;
+}
+
+bool bound_cache_enabled(dist_t& dist) {
+  return !cache_dir(dist).empty();
+}
+
+std::string bound_cache_key(dist_t& dist, std::string kind, int64_t G, double q, int64_t iprime, const std::vector<double>& errs, const std::vector<double>& xhats) {
+  std::string key = hex64(fingerprint(dist)) + " " + kind + " G=" + std::to_string(G) + " q=" + hexfloat(q) + " iprime=" + std::to_string(iprime) + " errs=";
+  for (size_t i=0; i<errs.size(); ++i) {
+    key += (i ? "," : "") + hexfloat(errs[i]);
+  }
+  key += " xhats=";
+  for (size_t i=0; i<xhats.size(); ++i) {
+    key += (i ? "," : "") + hexfloat(xhats[i]);
+  }
+  return key;
+}
+
+static std::filesystem::path entry_path(dist_t& dist, const std::string& key) {
+  return std::filesystem::path(cache_dir(dist)) / hex64(fingerprint(dist)) / hex64(fnv1a(key.data(), key.size()));
+}
+
+bool bound_cache_lookup(dist_t& dist, const std::string& key, double& value) {
+  if (!bound_cache_enabled(dist)) {
+    return false;
+  }
+  prof_span span("cache lookup");
+  std::ifstream in(entry_path(dist, key));
+  std::string stored_key, stored_value;
+  if (!in || !std::getline(in, stored_key) || !std::getline(in, stored_value) || stored_key != key) {
+    cache_misses++;
+    return false;
+  }
+  char* end = nullptr;
+  value = std::strtod(stored_value.c_str(), &end);
+  if (end == stored_value.c_str()) {
+    cache_misses++;
+    return false;
+  }
+  cache_hits++;
+  return true;
+}
+
+void bound_cache_store(dist_t& dist, const std::string& key, double value) {
+  if (!bound_cache_enabled(dist)) {
+    return;
+  }
+  prof_span span("cache store");
+  if (write_file_atomic(dist, entry_path(dist, key).string(), key + "\n" + hexfloat(value) + "\n")) {
+    cache_stored++;
+  }
+}
+
+bool write_file_atomic(dist_t& dist, std::string filename, const std::string& content) {
+  std::filesystem::path path(filename);
+  std::error_code ec;
+  std::filesystem::create_directories(path.parent_path(), ec);
+  if (ec) {
+    if (dist.verbose) {
+      std::cerr << "\n[Warning: Cannot create directory " << path.parent_path().string() << ".]" << std::endl;
+    }
+    return false;
+  }
+
+  // a name no other writer uses, renamed over the file once complete
+  static std::atomic<uint64_t> counter(0);
+  static const uint64_t salt = std::random_device()();
+  uint64_t n = counter++;
+  std::filesystem::path tmp = path;
+  tmp += ".tmp" + hex64(salt ^ fnv1a(&n, sizeof(n)));
+  {
+    std::ofstream out(tmp);
+    out << content;
+    if (!out) {
+      std::filesystem::remove(tmp, ec);
+      return false;
+    }
+  }
+  std::filesystem::rename(tmp, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp, ec);
+    return false;
+  }
+  return true;
+}
+
+uint64_t hash_string(const std::string& s) {
+  return fnv1a(s.data(), s.size());
+}
+
+bound_cache_stats get_bound_cache_stats() {
+  bound_cache_stats stats;
+  stats.hits = cache_hits.load();
+  stats.misses = cache_misses.load();
+  stats.stored = cache_stored.load();
+  return stats;
+}
+
+void reset_bound_cache_stats() {
+  cache_hits = 0;
+  cache_misses = 0;
+  cache_stored = 0;
+}
+
+void print_bound_cache_stats() {
+  bound_cache_stats stats = get_bound_cache_stats();
+  std::cout << "[Info] bound cache hits: " << stats.hits << "; misses: " << stats.misses << "; stored: " << stats.stored << std::endl;
+}
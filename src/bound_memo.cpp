@@ -0,0 +1,72 @@
+#include "bound_memo.hpp"
+
+#include <iostream>
+#include <cstdio>
+#include <vector>
+#include <algorithm>
+
+static std::string memo_key(std::string name, int64_t G, double err, std::string preset) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%a", err);
+  return name + "|" + std::to_string(G) + "|" + buf + "|" + preset;
+}
+
+// drop the least recently used quarter once the memo is over capacity
+static void memo_evict(bound_memo_t& memo) {
+  if ((int64_t) memo.entries.size() <= memo.capacity) {
+    return;
+  }
+  std::vector<uint64_t> ticks;
+  for (auto& e:memo.entries) {
+    ticks.push_back(e.second.second);
+  }
+  int64_t keep = memo.capacity - memo.capacity / 4;
+  std::nth_element(ticks.begin(), ticks.end() - keep, ticks.end());
+  uint64_t oldest_kept = *(ticks.end() - keep);
+  for (auto it=memo.entries.begin(); it!=memo.entries.end(); ) {
+    it = (it->second.second < oldest_kept) ? memo.entries.erase(it) : std::next(it);
+  }
+}
+
+bool memo_lookup(dist_t& dist, std::string name, int64_t G, double err, std::string preset, double& value) {
+  bound_memo_t& memo = dist.memo;
+  if (memo.capacity <= 0) {
+    return false;
+  }
+  auto it = memo.entries.find(memo_key(name, G, err, preset));
+  if (it == memo.entries.end()) {
+    memo.misses++;
+    return false;
+  }
+  memo.hits++;
+  it->second.second = ++memo.tick;
+  value = it->second.first;
+  return true;
+}
+
+void memo_store(dist_t& dist, std::string name, int64_t G, double err, std::string preset, double value) {
+  bound_memo_t& memo = dist.memo;
+  if (memo.capacity <= 0 || !(value >= 0 || value == -2)) {
+    return;
+  }
+  memo.entries[memo_key(name, G, err, preset)] = {value, ++memo.tick};
+  memo_evict(memo);
+}
+
+void clear_memo(dist_t& dist) {
+  dist.memo.entries.clear();
+}
+
+void set_memo_capacity(dist_t& dist, int64_t capacity) {
+  dist.memo.capacity = capacity;
+  if (capacity <= 0) {
+    dist.memo.entries.clear();
+  }
+  else {
+    memo_evict(dist.memo);
+  }
+}
+
+void print_memo_stats(dist_t& dist) {
+  std::cout << "[Info] bound memo hits: " << dist.memo.hits << "; misses: " << dist.memo.misses << "; entries: " << dist.memo.entries.size() << "/" << dist.memo.capacity << std::endl;
+}
@@ -5,10 +5,12 @@
 
 #include "helpers.hpp"
 #include "error_check.hpp"
+#include "profiler.hpp"
 
 // LP paper
 
 double freq_UB(dist_t& dist, int64_t G, double err) { // Coro 4
+  prof_span span("freq_UB", "G", (double) G);
   if (!error_check_basic(dist, G, err)) {
     return -1;
   }
@@ -19,6 +21,7 @@ double freq_UB(dist_t& dist, int64_t G, double err) { // Coro 4
 }
 
 double samp_LB(dist_t& dist, int64_t G, double err) { // Thm 5
+  prof_span span("samp_LB", "G", (double) G);
   if (!error_check_with_partition(dist, G, err)) {
     return -1;
   }
@@ -44,6 +47,7 @@ double samp_LB(dist_t& dist, int64_t G, double err) { // Thm 5
 }
 
 double extended_LB(dist_t& dist, int64_t G, double err) { // Coro 7
+  prof_span span("extended_LB", "G", (double) G);
   if (!error_check_with_attack(dist, G, err)) {
     return -1;
   }
@@ -107,6 +111,7 @@ double prior_LB(dist_t& dist, int64_t G, int64_t j, double err) { // Thm 9
 }
 
 double best_prior_LB(dist_t& dist, int64_t G, double err1, double err2) { // Thm 9
+  prof_span span("best_prior_LB", "G", (double) G);
   if (!error_check_prior_LB(dist, G, 2, err1, err2)) {
     return -1;
   }
@@ -128,6 +133,7 @@ double best_prior_LB(dist_t& dist, int64_t G, double err) {
 // PIN paper
 
 double binom_LB(dist_t& dist, int64_t G, double err) { // Coro 4
+  prof_span span("binom_LB", "G", (double) G);
   if (!error_check_with_partition(dist, G, err)) {
     return -1;
   }
@@ -167,6 +173,7 @@ double binom_LB(dist_t& dist, int64_t G, double err) { // Coro 4
 }
 
 double binom_UB(dist_t& dist, int64_t G, double err) { // Thm 2
+  prof_span span("binom_UB", "G", (double) G);
   if (!error_check_basic(dist, G, err)) {
     return -1;
   }
@@ -0,0 +1,50 @@
+#include "bpdf_table.hpp"
+
+#include <mutex>
+
+#include "helpers.hpp"
+#include "profiler.hpp"
+
+static std::mutex tables_mutex;
+static std::vector<std::shared_ptr<const bpdf_table>> tables;
+static const size_t MAX_TABLES = 16; // adaptive meshes make a new table per refinement step
+
+// the cached table for (N, mesh) is reused for any iprime it covers; a request
+// with a larger iprime replaces it; beyond MAX_TABLES the oldest one is dropped
+std::shared_ptr<const bpdf_table> get_bpdf_table(int64_t N, const std::vector<double>& mesh, int64_t iprime) {
+  std::lock_guard<std::mutex> lock(tables_mutex);
+
+  for (auto it=tables.begin(); it!=tables.end(); ++it) {
+    if ((*it)->N == N && (*it)->mesh == mesh) {
+      if ((*it)->iprime >= iprime) {
+        return *it;
+      }
+      tables.erase(it);
+      break;
+    }
+  }
+
+  prof_span span("bpdf table", "entries", (double) ((iprime + 1) * mesh.size()));
+  prof_count("bpdf evaluations", (iprime + 1) * (int64_t) mesh.size());
+  populate_logs(N);
+  std::shared_ptr<bpdf_table> table(new bpdf_table());
+  table->N = N;
+  table->iprime = iprime;
+  table->mesh = mesh;
+  table->vals.resize((iprime + 1) * mesh.size());
+  for (int64_t i=0; i<=iprime; ++i) {
+    for (int64_t j=0; j<(int64_t) mesh.size(); ++j) {
+      table->vals[i * mesh.size() + j] = bpdf(i, N, mesh[j]);
+    }
+  }
+  if (tables.size() >= MAX_TABLES) {
+    tables.erase(tables.begin());
+  }
+  tables.push_back(table);
+  return table;
+}
+
+void clear_bpdf_tables() {
+  std::lock_guard<std::mutex> lock(tables_mutex);
+  tables.clear();
+}
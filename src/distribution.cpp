@@ -8,6 +8,8 @@
 #include <fstream>
 #include <sstream>
 
+#include "bound_memo.hpp"
+
 void print1(dist_t& d) {
   std::cout << "-----------------\n";
   std::cout << "Dataset\n";
@@ -40,6 +42,35 @@ void set_verbose(dist_t& d, bool verbose) {
   d.verbose = verbose;
 }
 
+void set_solver(dist_t& d, std::string solver) {
+  d.solver = solver;
+  clear_memo(d);
+}
+
+void set_threads(dist_t& d, int threads) {
+  d.threads = threads;
+}
+
+void set_certify(dist_t& d, bool certify, double tolerance) {
+  d.certify = certify;
+  d.lp_tolerance = tolerance;
+  clear_memo(d);
+}
+
+void set_lp_scaling(dist_t& d, bool scaling) {
+  d.lp_scaling = scaling;
+  clear_memo(d);
+}
+
+void set_cache_dir(dist_t& d, std::string dir) {
+  d.cache_dir = dir;
+}
+
+void set_checkpoint(dist_t& d, std::string dir, double interval) {
+  d.checkpoint_dir = dir;
+  d.checkpoint_interval = interval;
+}
+
 int64_t most_frequent(dist_t& dist, int64_t G) { // cumulative frequency of top G most frequent passwords
   auto it = std::lower_bound(dist.prefcount.begin(), dist.prefcount.end(), G);
   if (it == dist.prefcount.begin()) {
@@ -54,6 +85,25 @@ int64_t most_frequent(dist_t& dist, int64_t G) { // cumulative frequency of top
   }
 }
 
+/*
+Good-Turing估计 k*f_k/(N-k+1)，f_k为出现恰好k次的口令个数
+dist.good_turing按k稠密存放，只展开到需要的kmax（LP只用到 k <= iprime+1），读取时没有查表和内存分配
+freqcount重新读入时清空
+多线程使用前需先在串行部分调用一次，之后的调用只读
+*/
+const std::vector<double>& good_turing_estimates(dist_t& dist, int64_t kmax) {
+  if ((int64_t) dist.good_turing.size() > kmax) {
+    return dist.good_turing;
+  }
+  dist.good_turing.assign(kmax+1, 0.0);
+  for (auto x:dist.freqcount) {
+    if (x.first <= kmax) {
+      dist.good_turing[x.first] = ((double) x.first * x.second) / (dist.N - x.first + 1.0);
+    }
+  }
+  return dist.good_turing;
+}
+
 void partition_small_d(dist_t& dist, int64_t d) {
   std::random_device rd;
   std::mt19937 gen(rd());
@@ -190,6 +240,7 @@ bool partition(dist_t& dist, int64_t d, std::string D1_filename, std::string D2_
     return false;
   }
 
+  clear_memo(dist); // binom LB depends on the partition
   if (d * 10 <= dist.N) {
     partition_small_d(dist, d);
   }
@@ -313,6 +364,7 @@ bool pre_partition(dist_t& dist, int64_t d) {
     return false;
   }
 
+  clear_memo(dist); // binom LB depends on the partition
   dist.D2_idx.resize(d);
   for (int i=1; i<=d; ++i) {
     dist.D2_idx[i] = i;
@@ -3,9 +3,45 @@
 #include <vector>
 #include <cmath>
 #include <iostream>
+#include <memory>
+#include <atomic>
+#include <mutex>
 
-std::vector<double> logs = {0};
-std::vector<double> logpref = {0};
+#include "profiler.hpp"
+
+/*
+logpref[i] = log2(i!)，按用到的最大N惰性增长
+  不同数据集的计算可以在不同线程里同时进行（见thread_budget.hpp）：增长在锁里复制出一张更长的表，再用release发布它的指针，
+  logbpdf只做一次acquire读，不加锁、不改引用计数；旧表留在logpref_tables里不释放，还在用它的读者不受影响
+  （旧表只在N增大时产生，是新表的前缀）；并行区域之前用populate_logs增长到要用的N，循环里就不会再进锁
+*/
+static std::mutex logs_mutex;
+static std::vector<std::unique_ptr<const std::vector<double>>> logpref_tables; // every published table, guarded by logs_mutex
+static const std::vector<double> logpref_initial(1, 0.0);
+static std::atomic<const std::vector<double>*> logpref_table(&logpref_initial);
+
+static const std::vector<double>& logpref_upto(int64_t N) {
+  const std::vector<double>* table = logpref_table.load(std::memory_order_acquire);
+  if ((int64_t) table->size() > N) {
+    return *table;
+  }
+  std::lock_guard<std::mutex> lock(logs_mutex);
+  table = logpref_table.load(std::memory_order_acquire);
+  if ((int64_t) table->size() > N) {
+    return *table;
+  }
+  prof_span span("log table", "N", (double) N);
+  std::unique_ptr<std::vector<double>> grown(new std::vector<double>(*table));
+  int64_t old_size = grown->size();
+  grown->resize(N+1);
+  for (int64_t i=old_size; i<=N; ++i) {
+    (*grown)[i] = (*grown)[i-1] + log2((double) i);
+  }
+  table = grown.get();
+  logpref_tables.push_back(std::move(grown));
+  logpref_table.store(table, std::memory_order_release);
+  return *table;
+}
 
 double fpow(double a, int64_t p) {
   double res = 1.0;
@@ -18,20 +54,11 @@ double fpow(double a, int64_t p) {
 }
 
 void populate_logs(int64_t N) {
-  if (logs.size() > N) {
-    return;
-  }
-  int64_t old_size = logs.size();
-  logs.resize(N+1);
-  logpref.resize(N+1);
-  for (int64_t i=old_size; i<=N; ++i) {
-    logs[i] = log2((double) i);
-    logpref[i] = logpref[i-1] + logs[i];
-  }
+  logpref_upto(N);
 }
 
 double logbpdf(int64_t i, int64_t N, double p) {
-  populate_logs(N);
+  const std::vector<double>& logpref = logpref_upto(N);
   return logpref[N] - logpref[i] - logpref[N-i] + log2(p)*i + log2(1-p)*(N-i);
 }
 
@@ -0,0 +1,38 @@
+#include "lp_backend.hpp"
+
+#include <iostream>
+#include <cstdlib>
+
+/*
+name: "gurobi", "simplex" 或 "auto"
+  "auto": 环境变量LP_SOLVER指定时用它，否则用内置simplex；
+  Gurobi后端还没有在真正的Gurobi上编译、运行过（见lp_backend_gurobi.cpp），只有显式选择
+  （set_solver(dist, "gurobi")或LP_SOLVER=gurobi）时才用
+*/
+std::unique_ptr<lp_backend> make_lp_backend(const std::string& name) {
+  if (name == "auto") {
+    const char* env = std::getenv("LP_SOLVER");
+    if (env != nullptr && std::string(env) != "auto") {
+      return make_lp_backend(env);
+    }
+    return make_simplex_backend();
+  }
+  else if (name == "gurobi") {
+    return make_gurobi_backend();
+  }
+  else if (name == "simplex") {
+    return make_simplex_backend();
+  }
+  throw lp_error(-1, "unknown LP solver '" + name + "', choose between 'auto', 'gurobi' and 'simplex'");
+}
+
+std::vector<std::string> available_lp_backends() {
+  std::vector<std::string> res;
+  try {
+    make_gurobi_backend();
+    res.push_back("gurobi");
+  } catch(const lp_error& e) {
+  }
+  res.push_back("simplex");
+  return res;
+}
@@ -0,0 +1,233 @@
+#include "lp_backend.hpp"
+
+#ifdef HAVE_GUROBI
+
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+#include "gurobi_c++.h"
+
+#include "lp_env.hpp"
+
+/*
+gurobi_lp: lp_backend在Gurobi上的实现，模型建在当前线程的pooled_env上
+  未经测试：这个文件还没有在真正的Gurobi上编译、运行过（HAVE_GUROBI分支只对着桩头文件做过语法检查），
+  也还没有用LPBench和内置simplex比较过结果和耗时
+*/
+class gurobi_lp : public lp_backend {
+ public:
+  gurobi_lp() : model(pooled_env()) {
+    // one Gurobi thread unless the thread budget gives the model more, see set_threads
+    model.set(GRB_IntParam_Threads, 1);
+  }
+
+  int add_var(double lb, double ub, double obj) override {
+    try {
+      vars.push_back(model.addVar(lb, ub, obj, GRB_CONTINUOUS));
+      return vars.size() - 1;
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  int add_row(double lo, double hi, const std::vector<int>& idx, const std::vector<double>& vals) override {
+    try {
+      GRBLinExpr expr = 0.0;
+      for (int t=0; t<(int) idx.size(); ++t) {
+        expr += vals[t] * vars[idx[t]];
+      }
+      if (lo == hi) {
+        rows.push_back(model.addConstr(expr, GRB_EQUAL, lo));
+      }
+      else if (lo == -INF) {
+        rows.push_back(model.addConstr(expr, GRB_LESS_EQUAL, hi));
+      }
+      else if (hi == INF) {
+        rows.push_back(model.addConstr(expr, GRB_GREATER_EQUAL, lo));
+      }
+      else {
+        rows.push_back(model.addRange(expr, lo, hi));
+      }
+      return rows.size() - 1;
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  void set_coeff(int row, int var, double val) override {
+    try {
+      model.chgCoeff(rows[row], vars[var], val);
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  void set_obj(int var, double val) override {
+    try {
+      vars[var].set(GRB_DoubleAttr_Obj, val);
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  // a row can switch between equality and one-sided, ranges (addRange) can't be changed
+  void set_row_bounds(int row, double lo, double hi) override {
+    try {
+      if (lo == hi) {
+        rows[row].set(GRB_CharAttr_Sense, GRB_EQUAL);
+        rows[row].set(GRB_DoubleAttr_RHS, lo);
+      }
+      else if (lo == -INF) {
+        rows[row].set(GRB_CharAttr_Sense, GRB_LESS_EQUAL);
+        rows[row].set(GRB_DoubleAttr_RHS, hi);
+      }
+      else if (hi == INF) {
+        rows[row].set(GRB_CharAttr_Sense, GRB_GREATER_EQUAL);
+        rows[row].set(GRB_DoubleAttr_RHS, lo);
+      }
+      else {
+        throw lp_error(-1, "changing the bounds of a range constraint is not supported");
+      }
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  void set_maximize(bool maximize) override {
+    try {
+      model.set(GRB_IntAttr_ModelSense, maximize ? GRB_MAXIMIZE : GRB_MINIMIZE);
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  void set_cutoff(double cutoff) override {
+    try {
+      if (!std::isfinite(cutoff)) { // no cutoff: Gurobi's default for the current sense
+        cutoff = (model.get(GRB_IntAttr_ModelSense) == GRB_MAXIMIZE) ? -GRB_INFINITY : GRB_INFINITY;
+      }
+      model.set(GRB_DoubleParam_Cutoff, cutoff);
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  void set_tolerance(double tol) override {
+    try {
+      tol = std::min(std::max(tol, 1e-9), 1e-2); // the range Gurobi accepts
+      model.set(GRB_DoubleParam_FeasibilityTol, tol);
+      model.set(GRB_DoubleParam_OptimalityTol, tol);
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  void set_scaling(bool on) override {
+    try {
+      model.set(GRB_IntParam_ScaleFlag, on ? -1 : 0);
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  void set_threads(int threads) override {
+    try {
+      model.set(GRB_IntParam_Threads, std::max(threads, 1));
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  int solve() override {
+    try {
+      // Gurobi keeps the previous basis, so this is warm-started after modifications
+      model.optimize();
+      int status = model.get(GRB_IntAttr_Status);
+      if (status == GRB_OPTIMAL) {
+        return LP_OPTIMAL;
+      }
+      else if (status == GRB_INFEASIBLE) {
+        return LP_INFEASIBLE;
+      }
+      else if (status == GRB_CUTOFF) {
+        return LP_CUTOFF;
+      }
+      return LP_OTHER;
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  double objective() override {
+    try {
+      return model.get(GRB_DoubleAttr_ObjVal);
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  double value(int var) override {
+    try {
+      return vars[var].get(GRB_DoubleAttr_X);
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  double reduced_cost(int var) override {
+    try {
+      return vars[var].get(GRB_DoubleAttr_RC);
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  double dual(int row) override {
+    try {
+      return rows[row].get(GRB_DoubleAttr_Pi);
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  void reset() override {
+    try {
+      model.reset();
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+  int64_t iterations() override {
+    try {
+      return (int64_t) model.get(GRB_DoubleAttr_IterCount);
+    } catch(const GRBException& e) {
+      throw lp_error(e.getErrorCode(), e.getMessage());
+    }
+  }
+
+ private:
+  static constexpr double INF = std::numeric_limits<double>::infinity();
+
+  GRBModel model;
+  std::vector<GRBVar> vars;
+  std::vector<GRBConstr> rows;
+};
+
+std::unique_ptr<lp_backend> make_gurobi_backend() {
+  try {
+    return std::unique_ptr<lp_backend>(new gurobi_lp());
+  } catch(const GRBException& e) {
+    throw lp_error(e.getErrorCode(), e.getMessage());
+  }
+}
+
+#else
+
+// built without Gurobi (see CMakeLists.txt), only the simplex backend can be used
+std::unique_ptr<lp_backend> make_gurobi_backend() {
+  throw lp_error(-1, "this build has no Gurobi support");
+}
+
+#endif
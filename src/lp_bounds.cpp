@@ -1,14 +1,30 @@
 #include "lp_bounds.hpp"
 
 #include <iostream>
-#include <unordered_map>
 #include <cmath>
 #include <numeric>
-
-#include "gurobi_c++.h"
+#include <algorithm>
+#include <limits>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <queue>
+#include <tuple>
 
 #include "helpers.hpp"
 #include "error_check.hpp"
+#include "lp_backend.hpp"
+#include "bpdf_table.hpp"
+#include "bound_cache.hpp"
+#include "bound_memo.hpp"
+#include "sweep_checkpoint.hpp"
+#include "thread_budget.hpp"
+#include "profiler.hpp"
+
 /*
 LP_UB选定fast, normal, slow三种精度模式
 fast: q=1.008 normal: q=1.004 slow: q=1.002
@@ -16,241 +32,383 @@ fast: q=1.008 normal: q=1.004 slow: q=1.002
 LP_UB和LP_LB函数中调用LP_upper和LP_lower函数进行线性规划求解
 */
 
+static const int64_t LP_CG_MIN_COLUMNS = 1024; // meshes with at least this many columns use column generation
+static const int64_t LP_CG_START_COLUMNS = 256; // columns of the initial master
+static const int64_t LP_CG_BATCH = 32; // columns added per pricing round
+static const double LP_CG_TOL = 1e-9; // reduced costs above -LP_CG_TOL don't improve
+static const double LP_AGG_TOL = 1e-12; // coefficient spread within an aggregated run of columns
+static const double LP_STRICT_TOL = 1e-9; // solver tolerance that confirms infeasibility under a looser lp_tolerance
+
+static std::atomic<int64_t> stat_iterations(0); // simplex iterations of all LP_sweep solves, see lp_sweep_stats
+
+// one solve of the current model, counted in stat_iterations and the profile
+static int solve_counted(lp_backend& lp) {
+  prof_span span("lp solve");
+  int status = lp.solve();
+  stat_iterations += lp.iterations();
+  prof_count("simplex iterations", lp.iterations());
+  return status;
+}
+
 /*
-@ parameters:
-  dist表F^S，G为猜测次数
-  mesh对应X_l表网络，q为网络精度参数
-  iprime对应i'，用于区分高频和低频元素，idx为攻击者在网格上的猜测范围
+LP_sweep: 同一(G, mesh, q, iprime)下idx扫描共用的LP模型
+  l个网格变量、p、c以及约束(2)(3)只建一次；
+  set_idx只修改随idx变化的部分：目标函数前缀、约束(1)的系数/右端项、约束(4)，
+  求解器保留上一次的基，作为下一次求解的热启动
+  solve的cutoff为当前最优值，求解器证明LP(idx)不会更好时提前停止并返回-5
+  G只出现在约束(1)的右端项和缩放中，set_G换一个G后保留当前的基：缩放不改变基的选取，
+  基对新的右端项仍然原始可行时就是最优基（右端项灵敏度范围内），求解器不用换基
+  err只出现在约束(2)的右端项（eps2s）中，set_eps2同样只改右端项、保留基（多个err共用一个模型，见LP_curve_levels）
+  模型通过lp_backend建立，dist.solver选择求解器（"auto"、"gurobi"或内置的"simplex"）
+  列生成：聚合段以外的列不少于LP_CG_MIN_COLUMNS时，模型里只放等距抽出的一小部分列，
+  每次求解后用对偶按bpdf公式对其余的列定价，把检验数能改进最优值的列加进来再解，直到没有这样的列；
+  最优基至多 2*(iprime+1)+4 列，加进来的列在同一个模型的后续求解中保留。
+  没加进来的列检验数之和给出整个LP的拉格朗日界，cutoff用它判断；模型不可行时把其余的列全部加进来再判断
+  列聚合：约束(2)(3)的系数相差都不超过LP_AGG_TOL的连续多列（网格高端bpdf全部下溢的部分）只保留两端，见aggregate
+  threshold为true时建阈值形式的模型（见LP_threshold_curve）：没有约束(1)(4)和c，
+  solve_threshold(mu)求 min/max sum_j h_j (1 - mu/x_j)^+，同一个模型只按idx或只按mu求解
 */
-double LP_lower(dist_t& dist, int64_t G, std::vector<double>& mesh, double q, int64_t iprime, int64_t idx, std::vector<double>& eps2s, std::vector<double>& eps3s, std::vector<double>& xhats) {
+class LP_sweep {
+ public:
+  LP_sweep(dist_t& dist, int64_t G, std::vector<double>& mesh, double q, int64_t iprime, std::vector<double>& eps2s, std::vector<double>& eps3s, std::vector<double>& xhats, bool upper, bool threshold = false);
+  double solve(int64_t idx, double cutoff = std::numeric_limits<double>::infinity());
+  double solve_threshold(double mu, double cutoff = std::numeric_limits<double>::infinity());
+  bool row1_feasible(int64_t idx, bool below);
+  void set_G(int64_t G);
+  void set_eps2(const std::vector<double>& eps2s);
+  void solution(std::vector<double>& hx, std::vector<double>& rc);
+  double certified_bound();
+  bool certified_cutoff(double cutoff);
+  double max_ratio() const { return q_max; }
+  int64_t aggregated() const { return std::count(interior.begin(), interior.end(), true); }
 
-  int64_t l = mesh.size();
-  int64_t N = dist.N;
+ private:
+  void set_idx(int64_t idx);
+  void set_mu(double mu);
+  double solve_at(int64_t idx, double mu, double cutoff);
+  double obj_coeff(int64_t j) const;
+  double row1_coeff(int64_t j) const;
+  void row2_coeffs(int64_t i, double b, double ratio, double& a_lo, double& a_hi) const;
+  void row2_bounds(int64_t i, double eps2, double& lo, double& hi) const;
+  void raw_coeffs(int64_t j, double* a) const;
+  void column_coeffs(int64_t j, double* a) const;
+  double column_ub(int64_t j) const;
+  void aggregate();
+  void add_column(int64_t j);
+  double reduced_cost(int64_t j, double y_1, const std::vector<double>& y_23, std::vector<double>& a) const;
+  int optimize(double cutoff, bool feasibility);
+  int solve_model(double cutoff, bool feasibility);
 
-  std::unordered_map<int64_t, double> good_turing_estimates;
-  for (auto x:dist.freqcount) {
-    good_turing_estimates[x.first] = ((double) x.first * x.second) / (N - x.first + 1.0);
-  }
+  dist_t& dist;
+  int64_t G;
+  std::vector<double>& mesh;
+  int64_t l;
+  bool upper;
+  bool threshold;
+  double q;
+  double q_max; // largest bucket ratio of the mesh, q on a uniform mesh
+  std::vector<double> log_eps3s; // log(1+eps3) at q, see log1p_eps3
+  std::vector<double> eps2s; // right-hand sides of constraint (2) currently in the model
+  std::vector<double> eps3s;
+  std::vector<double> xhats;
+  std::vector<double> ratio; // r_j/q, see mesh_ratios
+  std::shared_ptr<const bpdf_table> table;
 
-  try {
-    GRBEnv env = GRBEnv(true);
-    env.set(GRB_IntParam_OutputFlag, 0);
-    env.start();
+  std::unique_ptr<lp_backend> lp;
+  std::vector<int> hx_vars; // hx_vars[i] is h_j * x_j, -1 for columns not in the model yet
+  int64_t n_absent = 0; // columns left to pricing: not in the model and not inside an aggregated run
+  std::vector<int64_t> group_of; // aggregated run of each column, -1 for none
+  std::vector<bool> interior; // inside an aggregated run, only added by set_idx
+  std::vector<double> group_coeffs; // relaxed coefficients of each run, in the order of column_coeffs
+  std::vector<double> group_ub;
+  int p_var;
+  int c_var; // c_var is c * x_idx
+  int constr_1;
+  std::vector<int> constr_23; // rows of constraints (2)(3), in the order of column_coeffs
+  int constr_4;
+  std::vector<double> p_coeffs, row_lo, row_hi; // coefficients of p and bounds of the rows of constr_23
 
-    GRBModel model = GRBModel(env);
+  int64_t cur_idx = 0; // idx the model currently encodes, 0 before the first set_idx
+  double cur_scale = 0.0;
+  double cur_c_row1 = 0.0; // coefficient of c in constraint (1)
+  double cur_mu = std::numeric_limits<double>::infinity(); // threshold of the objective in threshold mode
+};
 
-    // variables
-    std::vector<GRBVar> hx_vars(l); // hx_vars[i] is h_j * x_j
-    for (int i=0; i<l; ++i) {
-      hx_vars[i] = model.addVar(0.0, 1.0, 0.0, GRB_CONTINUOUS, "hx_vars["+std::to_string(i)+"]");
+/*
+网格各列的桶比r_j：LB把概率向下取到网格点，桶为[x_j, x_{j-1})，r_j = x_{j-1}/x_j；
+UB向上取，桶为(x_{j+1}, x_j]，r_j = x_j/x_{j+1}；
+两端：LB的最高一列桶为[x_0, 1]，r_0 = max(1/x_0, q)，UB的最低一列与原来一样按q算（再往下是p）。
+均匀网格上r_j都是q，非均匀网格（LP_LB_adaptive加密过的）逐列不同。
+返回 r_j/q，与1只差舍入误差的直接取1，均匀网格上的模型因此与原来逐位相同
+*/
+static std::vector<double> mesh_ratios(const std::vector<double>& mesh, double q, bool upper) {
+  int64_t l = mesh.size();
+  std::vector<double> ratio(l, 1.0);
+  for (int64_t j=0; j<l; ++j) {
+    double r = 1.0;
+    if (upper) {
+      r = (j < l-1) ? mesh[j] / mesh[j+1] / q : 1.0;
     }
-    GRBVar p_var = model.addVar(0.0, 1.0, 0.0, GRB_CONTINUOUS, "p_var");
-    GRBVar c_var = model.addVar(0.0, 1.0, 0.0, GRB_CONTINUOUS, "c_var"); // c_var is c * x_idx
-
-    // objective
-    GRBLinExpr obj = 0.0;
-    for (int i=0; i<idx-1; ++i) { // idx-1 is because of 1-indexing in paper vs. 0-indexing in program
-      obj += hx_vars[i];
+    else {
+      r = (j > 0) ? mesh[j-1] / mesh[j] / q : std::max(1.0 / (mesh[0] * q), 1.0);
     }
-    if (idx <= l) {
-      obj += c_var;
+    if (fabs(r - 1.0) > 1e-9) {
+      ratio[j] = r;
     }
-    model.setObjective(obj, GRB_MINIMIZE);
+  }
+  return ratio;
+}
 
-    // constraints
+// 桶比为r时的eps3（LP_eps中取r=q），即 bpdf(i,N,x)/bpdf(i,N,r*x) - 1 在 x <= xhat 上的上界，返回log(1+eps3)
+static double log1p_eps3(int64_t N, int64_t i, double r, double xhat) {
+  return (N - i) * log((1 - xhat) / (1 - r*xhat)) - (i + 1) * log(r);
+}
 
-    // constraint (1)
-    GRBLinExpr constr_1_lhs = 0.0;
-    double scale = 0.0;
-    if(idx<=l){
-      scale=(G/mesh[idx-1]>=1.0) ? 1.0/G : mesh[idx-1];
-    }
-    else{
-      scale=1.0/G;
-    }
-    for (int i=0; i<idx-1; ++i) {
-      constr_1_lhs += hx_vars[i] * scale / mesh[i];
-    }
-    if (idx <= l) {
-      constr_1_lhs += c_var * scale / mesh[idx-1];
-    }else {
-      constr_1_lhs += c_var;
-    }
-    GRBLinExpr constr_1_rhs = G * scale;
-    model.addConstr(constr_1_lhs, GRB_EQUAL, constr_1_rhs, "1) (sum{j<idx} h_j) + c == G");
+/*
+@ parameters:
+  dist表F^S，G为猜测次数
+  mesh对应X_l表网络，q为网络精度参数，eps3s按q计算
+  iprime对应i'，用于区分高频和低频元素，idx为攻击者在网格上的猜测范围
+  upper为true时建LP_upper的模型，否则建LP_lower的模型
+约束(2)(3)两端含p的项移到左边，写成 lo <= sum_j a_j h_j + a_p p <= hi 的形式
+非均匀网格上，约束(2)(3)里每一列由桶比产生的因子按该列自己的r_j计算：
+  q^{i+1}、q换成r_j^{i+1}、r_j，(1+eps3)换成按r_j算的(1+eps3_j)，都是逐列成立的不等式，写成相对q的因子乘到系数上；
+  不属于某一列的p和xhat的项按网格中最大的桶比q_max计算
+*/
+LP_sweep::LP_sweep(dist_t& dist, int64_t G, std::vector<double>& mesh, double q, int64_t iprime, std::vector<double>& eps2s, std::vector<double>& eps3s, std::vector<double>& xhats, bool upper, bool threshold)
+  : dist(dist), G(G), mesh(mesh), l(mesh.size()), upper(upper), threshold(threshold), q(q), eps2s(eps2s), eps3s(eps3s), xhats(xhats), lp(make_lp_backend(dist.solver)), hx_vars(mesh.size()) {
+  prof_span span("model build", "G", (double) G);
 
-    // constraint (2)
-    for (int i=0; i<=iprime; ++i) {
-      GRBLinExpr sum_hxvars_bpdf = 0.0;
-      GRBLinExpr lb = 0.0;
-      GRBLinExpr ub = 0.0;
-      for (int j=0; j<l; ++j) {
-        sum_hxvars_bpdf += hx_vars[j] * bpdf(i, N, mesh[j]);
-      }
-      if (i==0) {
-        lb = (1.0 / pow(q, i+1)) * (good_turing_estimates[i+1] - eps2s[i] - ((double) (i+1))/((double) (N-i)) - p_var);
-        ub = (1.0 + eps3s[i]) * (good_turing_estimates[i+1] + eps2s[i] - p_var * bpdf(i, N, q * mesh[l-1])) + bpdf(i, N, xhats[i]);
-      }
-      else {
-        lb = (1.0 / pow(q, i+1)) * (good_turing_estimates[i+1] - eps2s[i] - ((double) (i+1))/((double) (N-i)) - p_var * bpdf(i, N, q * mesh[l-1]));
-        ub = (1.0 + eps3s[i]) * (good_turing_estimates[i+1] + eps2s[i]) + bpdf(0, N, xhats[i]);
-      }
-      model.addConstr(lb, GRB_LESS_EQUAL, sum_hxvars_bpdf, "2) lb");
-      model.addConstr(sum_hxvars_bpdf, GRB_LESS_EQUAL, ub, "2) ub");
-    }
-    
-    // constraint (3)
-    GRBLinExpr left = (1.0 - p_var) / q;
-    GRBLinExpr right = 1.0 - p_var;
-    GRBLinExpr sum_hxvars = 0.0;
-    for (int i=0; i<l; ++i) {
-      sum_hxvars += hx_vars[i];
-    }
-    model.addConstr(left, GRB_LESS_EQUAL, sum_hxvars, "3) 1-p/q <= sum h_j");
-    model.addConstr(sum_hxvars, GRB_LESS_EQUAL, right, "3) sum h_j <= 1-p");
-    
-    // constraint (4)
-    if (idx <= l) {
-      model.addConstr(c_var <= hx_vars[idx-1], "4) c <= h_idx");
-    }
+  const double inf = std::numeric_limits<double>::infinity();
+  int64_t N = dist.N;
 
+  good_turing_estimates(dist, iprime+1);
+  ratio = mesh_ratios(mesh, q, upper);
+  q_max = q * *std::max_element(ratio.begin(), ratio.end());
+  table = get_bpdf_table(N, mesh, iprime);
+  for (int i=0; i<=iprime; ++i) {
+    log_eps3s.push_back(log1p_eps3(N, i, q, xhats[i]));
+  }
 
-    // optimize 
-    model.optimize();
+  aggregate();
+  if (dist.lp_tolerance > 0) {
+    lp->set_tolerance(dist.lp_tolerance);
+  }
+  lp->set_scaling(dist.lp_scaling);
+  lp->set_threads(thread_budget(dist));
 
-    // status/solution
-    int status = model.get(GRB_IntAttr_Status);
-		if (status == GRB_OPTIMAL) {
-      return model.get(GRB_DoubleAttr_ObjVal);
-		}
-    else if (status == GRB_INFEASIBLE) {
-      return -2;
+  // variables; with column generation only every stride-th column (and the last one) to start with
+  int64_t n_candidates = l - std::count(interior.begin(), interior.end(), true);
+  int64_t stride = (n_candidates >= LP_CG_MIN_COLUMNS) ? l / LP_CG_START_COLUMNS : 1;
+  std::vector<int64_t> cols;
+  for (int64_t j=0; j<l; ++j) {
+    if (!interior[j] && (j % stride == 0 || j == l-1)) {
+      cols.push_back(j);
     }
-    else {
-      return -1;
+  }
+  std::fill(hx_vars.begin(), hx_vars.end(), -1);
+  for (auto j:cols) {
+    hx_vars[j] = lp->add_var(0.0, column_ub(j), 0.0);
+  }
+  int64_t n_cols = cols.size();
+  n_absent = n_candidates - n_cols;
+  p_var = lp->add_var(0.0, 1.0, 0.0);
+  c_var = threshold ? -1 : lp->add_var(0.0, 1.0, 0.0);
+
+  // objective, the idx-dependent prefix is filled in by set_idx (the weights by set_mu)
+  lp->set_maximize(upper);
+
+  // constraint (1): (sum{j<idx} h_j) + c == G, coefficients and rhs are filled in by set_idx
+  constr_1 = threshold ? -1 : lp->add_row(0.0, 0.0, {}, {});
+
+  // coefficients of the columns in constraints (2)(3)
+  int64_t n_rows = 2 * (iprime + 1) + 2;
+  std::vector<double> coeffs(n_cols * n_rows);
+  for (int64_t t=0; t<n_cols; ++t) {
+    column_coeffs(cols[t], &coeffs[t * n_rows]);
+  }
+  std::vector<int> vars;
+  for (auto j:cols) {
+    vars.push_back(hx_vars[j]);
+  }
+  vars.push_back(p_var);
+  std::vector<double> vals(n_cols+1);
+  auto row_vals = [&](int64_t r) {
+    for (int64_t t=0; t<n_cols; ++t) {
+      vals[t] = coeffs[t * n_rows + r];
     }
-  } catch(GRBException e) {
-    if (dist.verbose) {
-      std::cerr << "\n[Error: code = " << e.getErrorCode() << "; message: " << e.getMessage() << ".]" << std::endl;
+  };
+  auto add_row_23 = [&](double lo, double hi) {
+    constr_23.push_back(lp->add_row(lo, hi, vars, vals));
+    p_coeffs.push_back(vals[n_cols]);
+    row_lo.push_back(lo);
+    row_hi.push_back(hi);
+  };
+
+  // constraint (2)
+  for (int i=0; i<=iprime; ++i) {
+    double p_low = (i==0) ? 1.0 : bpdf(i, N, q_max * mesh[l-1]); // weight of p in the lower side
+    double lo, hi, p_lo, p_hi;
+    row2_bounds(i, eps2s[i], lo, hi);
+    if (!upper) {
+      p_lo = p_low * (1.0 / pow(q, i+1));
+      p_hi = (i==0) ? (1.0 + eps3s[i]) * bpdf(i, N, q_max * mesh[l-1]) : 0.0;
     }
-    return -3;
-  } catch(...) {
-    if (dist.verbose) {
-      std::cerr << "\n[Error: Exception during optimization.]" << std::endl;
+    else {
+      p_lo = p_low * (1.0 / (1.0 + eps3s[i]));
+      p_hi = (i==0) ? pow(q, i+1) * bpdf(i, N, q_max * mesh[l-1]) : 0.0;
     }
-    return -4;
+    row_vals(2*i);
+    vals[n_cols] = p_lo;
+    add_row_23(lo, inf); // 2) lb
+    row_vals(2*i+1);
+    vals[n_cols] = p_hi;
+    add_row_23(-inf, hi); // 2) ub
+  }
+
+  // constraint (3)
+  row_vals(n_rows-2);
+  if (!upper) {
+    vals[n_cols] = 1.0 / q;
+    add_row_23(1.0 / q, inf); // 3) 1-p/q <= sum h_j
+    row_vals(n_rows-1);
+    vals[n_cols] = 1.0;
+    add_row_23(-inf, 1.0); // 3) sum h_j <= 1-p
+  }
+  else {
+    vals[n_cols] = 1.0;
+    add_row_23(1.0, inf); // 3) 1-p <= sum h_j
+    row_vals(n_rows-1);
+    vals[n_cols] = q;
+    add_row_23(-inf, q); // 3) sum h_j <= q*(1-p)
   }
 
-  return 0.0;
+  // constraint (4): c <= h_idx, coefficients are filled in by set_idx
+  constr_4 = threshold ? -1 : lp->add_row(-inf, 0.0, {}, {});
 }
 
-double LP_upper(dist_t& dist, int64_t G, std::vector<double>& mesh, double q, int64_t iprime, int64_t idx, std::vector<double>& eps2s, std::vector<double>& eps3s, std::vector<double>& xhats) {
+void LP_sweep::set_idx(int64_t idx) {
+  // constraint (4) needs h_{idx-1} in the model; an aggregated run cut by idx also needs the last column of its prefix part
+  if (idx <= l && hx_vars[idx-1] < 0) {
+    add_column(idx-1);
+  }
+  if (idx >= 2 && idx <= l+1 && interior[idx-2] && hx_vars[idx-2] < 0) {
+    add_column(idx-2);
+  }
 
-  int64_t l = mesh.size();
-  int64_t N = dist.N;
+  // constraint (1) scale
+  double scale = 0.0;
+  if (idx <= l) {
+    scale = (G/mesh[idx-1]>=1.0) ? 1.0/G : mesh[idx-1];
+  }
+  else {
+    scale = upper ? ((G/mesh[l-1]>=1.0) ? 1.0/G : mesh[l-1]) : 1.0/G;
+  }
 
-  std::unordered_map<int64_t, double> good_turing_estimates;
-  for (auto x:dist.freqcount) {
-    good_turing_estimates[x.first] = ((double) x.first * x.second) / (N - x.first + 1.0);
+  // hx_vars[j] for j<idx-1 are in the objective and constraint (1); only the
+  // range between the old and the new idx changes, unless the scale does
+  int64_t lo = std::max<int64_t>(std::min(cur_idx, idx)-1, 0);
+  int64_t hi = std::max(cur_idx, idx)-1;
+  if (scale != cur_scale) {
+    for (int64_t j=0; j<lo; ++j) {
+      if (hx_vars[j] < 0) {
+        continue;
+      }
+      lp->set_coeff(constr_1, hx_vars[j], scale / mesh[j]);
+    }
+  }
+  for (int64_t j=lo; j<hi; ++j) { // idx-1 is because of 1-indexing in paper vs. 0-indexing in program
+    if (hx_vars[j] < 0) {
+      continue;
+    }
+    bool in_prefix = j < idx-1;
+    lp->set_obj(hx_vars[j], in_prefix ? 1.0 : 0.0);
+    lp->set_coeff(constr_1, hx_vars[j], in_prefix ? scale / mesh[j] : 0.0);
   }
 
-  try {
-    GRBEnv env = GRBEnv(true);
-    env.set(GRB_IntParam_OutputFlag, 0);
-    env.start();
+  cur_c_row1 = (idx <= l) ? scale / mesh[idx-1] : upper ? scale / mesh[l-1] : 1.0;
+  lp->set_coeff(constr_1, c_var, cur_c_row1);
+  lp->set_row_bounds(constr_1, G * scale, G * scale);
+  lp->set_obj(c_var, (upper || idx <= l) ? 1.0 : 0.0);
+
+  // constraint (4), dropped (0 <= 0) when idx == l+1
+  if (cur_idx >= 1 && cur_idx <= l) {
+    lp->set_coeff(constr_4, hx_vars[cur_idx-1], 0.0);
+  }
+  if (idx <= l) {
+    lp->set_coeff(constr_4, hx_vars[idx-1], -1.0);
+  }
+  lp->set_coeff(constr_4, c_var, (idx <= l) ? 1.0 : 0.0);
 
-    GRBModel model = GRBModel(env);
+  cur_idx = idx;
+  cur_scale = scale;
+}
 
-    // variables
-    std::vector<GRBVar> hx_vars(l); // hx_vars[i] is h_j * x_j
-    for (int i=0; i<l; ++i) {
-      hx_vars[i] = model.addVar(0.0, 1.0, 0.0, GRB_CONTINUOUS, "hx_vars["+std::to_string(i)+"]");
+/*
+阈值形式的目标函数：sum_j h_j (1 - mu/x_j)^+，x_j <= mu的列权重为0
+  和set_idx一样，被mu切开的聚合段需要切点两侧的列k-1和k（x_k是第一个不超过mu的网格点）：
+  前缀部分的权重1 - mu/x_j是1/x_j的仿射函数，仍是两端列的锥组合
+*/
+void LP_sweep::set_mu(double mu) {
+  cur_mu = mu;
+  int64_t k = std::lower_bound(mesh.begin(), mesh.end(), mu, std::greater<double>()) - mesh.begin();
+  if (k < l && hx_vars[k] < 0) {
+    add_column(k);
+  }
+  if (k >= 1 && interior[k-1] && hx_vars[k-1] < 0) {
+    add_column(k-1);
+  }
+  for (int64_t j=0; j<l; ++j) {
+    if (hx_vars[j] >= 0) {
+      lp->set_obj(hx_vars[j], obj_coeff(j));
     }
-    GRBVar p_var = model.addVar(0.0, 1.0, 0.0, GRB_CONTINUOUS, "p_var");
-    GRBVar c_var = model.addVar(0.0, 1.0, 0.0, GRB_CONTINUOUS, "c_var"); // c_var is c * x_idx
+  }
+}
 
-    // objective
-    GRBLinExpr obj = 0.0;
-    for (int i=0; i<idx-1; ++i) { // idx-1 is because of 1-indexing in paper vs. 0-indexing in program
-      obj += hx_vars[i];
-    }
-    obj += c_var;
-    model.setObjective(obj, GRB_MAXIMIZE);
+double LP_sweep::solve(int64_t idx, double cutoff) {
+  return solve_at(idx, 0.0, cutoff);
+}
 
-    // constraints
+double LP_sweep::solve_threshold(double mu, double cutoff) {
+  return solve_at(0, mu, cutoff);
+}
 
-    // constraint (1)
-    GRBLinExpr constr_1_lhs = 0.0;
-    double scale = 0.0;
-    if (idx <= l) {
-    scale = (G/mesh[idx-1]>=1.0) ? 1.0/G : mesh[idx-1];
-    } else {
-    scale = (G/mesh[l-1]>=1.0) ? 1.0/G : mesh[l-1];
-    }
-    for (int i=0; i<idx-1; ++i) {
-      constr_1_lhs += hx_vars[i] * scale / mesh[i];
-    }
-    if (idx <= l) {
-      constr_1_lhs += c_var * scale / mesh[idx-1];
+double LP_sweep::solve_at(int64_t idx, double mu, double cutoff) {
+  prof_span span(threshold ? "threshold solve" : "idx solve", threshold ? "mu" : "idx", threshold ? mu : (double) idx);
+  try {
+    if (threshold) {
+      set_mu(mu);
     }
     else {
-      constr_1_lhs += c_var * scale / mesh[l-1];
+      set_idx(idx);
     }
-    GRBLinExpr constr_1_rhs = G * scale;
-    model.addConstr(constr_1_lhs, GRB_EQUAL, constr_1_rhs, "1) (sum{j<idx} h_j) + c == G");
 
-    // constraint (2)
-    for (int i=0; i<=iprime; ++i) {
-      GRBLinExpr sum_hxvars_bpdf = 0.0;
-      GRBLinExpr lb = 0.0;
-      GRBLinExpr ub = 0.0;
-      for (int j=0; j<l; ++j) {
-        sum_hxvars_bpdf += hx_vars[j] * bpdf(i, N, mesh[j]);
-      }
-      if (i==0) {
-        lb = (1.0 / (1.0 + eps3s[i])) * (good_turing_estimates[i+1] - eps2s[i] - ((double) (i+1))/((double) (N-i)) - p_var - bpdf(i, N, q * xhats[i]));
-        ub = pow(q, i+1) * (good_turing_estimates[i+1] + eps2s[i] - p_var * bpdf(i, N, q * mesh[l-1]));
-      }
-      else {
-        lb = (1.0 / (1.0 + eps3s[i])) * (good_turing_estimates[i+1] - eps2s[i] - ((double) (i+1))/((double) (N-i)) - p_var * bpdf(i, N, q * mesh[l-1]) - bpdf(i, N, q * xhats[i]));
-        ub = pow(q, i+1) * (good_turing_estimates[i+1] + eps2s[i]);
-      }
-      model.addConstr(lb, GRB_LESS_EQUAL, sum_hxvars_bpdf);
-      model.addConstr(sum_hxvars_bpdf, GRB_LESS_EQUAL, ub);
-    }
-    
-    // constraint (3)
-    GRBLinExpr left = 1.0 - p_var;
-    GRBLinExpr right = (1.0 - p_var) * q;
-    GRBLinExpr sum_hxvars = 0.0;
-    for (int i=0; i<l; ++i) {
-      sum_hxvars += hx_vars[i];
-    }
-    model.addConstr(left, GRB_LESS_EQUAL, sum_hxvars, "3) 1-p <= sum h_j");
-    model.addConstr(sum_hxvars, GRB_LESS_EQUAL, right, "3) sum h_j <= q*(1-p)");
-    
-    // constraint (4)
-    if (idx <= l) {
-      model.addConstr(c_var <= hx_vars[idx-1], "4) c <= h_idx");
+    // optimize, warm-started from the basis of the previous idx/mu
+    int status = optimize(cutoff, false);
+    if (status == LP_CUTOFF && dist.certify && !certified_cutoff(cutoff)) {
+      status = optimize(std::numeric_limits<double>::infinity(), false);
     }
 
-    // optimize 
-    model.optimize();
-
     // status/solution
-    int status = model.get(GRB_IntAttr_Status);
-		if (status == GRB_OPTIMAL) {
-      return model.get(GRB_DoubleAttr_ObjVal);
-		}
-    else if (status == GRB_INFEASIBLE) {
+    if (status == LP_OPTIMAL) {
+      if (dist.certify) { // the LPs' values are >= 0, a 0 LB would read as no value in the sweep
+        double bound = certified_bound();
+        return upper ? bound : std::max(bound, threshold ? 0.0 : std::numeric_limits<double>::denorm_min());
+      }
+      return lp->objective();
+    }
+    else if (status == LP_INFEASIBLE) {
       return -2;
     }
+    else if (status == LP_CUTOFF) {
+      return -5;
+    }
     else {
       return -1;
     }
-  } catch(GRBException e) {
+  } catch(const lp_error& e) {
     if (dist.verbose) {
-      std::cerr << "\n[Error: code = " << e.getErrorCode() << "; message: " << e.getMessage() << ".]" << std::endl;
+      std::cerr << "\n[Error: code = " << e.code << "; message: " << e.what() << ".]" << std::endl;
     }
     return -3;
   } catch(...) {
@@ -259,195 +417,2329 @@ double LP_upper(dist_t& dist, int64_t G, std::vector<double>& mesh, double q, in
     }
     return -4;
   }
+}
 
-  return 1.0;
+// 约束(2)第i对行的右端项：下界行lo、上界行hi，只有这里用到eps2
+void LP_sweep::row2_bounds(int64_t i, double eps2, double& lo, double& hi) const {
+  int64_t N = dist.N;
+  double gt = dist.good_turing[i+1];
+  if (!upper) {
+    double f = 1.0 / pow(q, i+1);
+    lo = f * (gt - eps2 - ((double) (i+1))/((double) (N-i)));
+    hi = (1.0 + eps3s[i]) * (gt + eps2) + bpdf(0, N, xhats[i]);
+  }
+  else {
+    double f = 1.0 / (1.0 + eps3s[i]);
+    lo = f * (gt - eps2 - ((double) (i+1))/((double) (N-i)) - bpdf(i, N, q_max * xhats[i]));
+    hi = pow(q, i+1) * (gt + eps2);
+  }
 }
 
-double LP_LB(dist_t& dist, int64_t G, double q, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
-  // Note: error rate will be 2 * sum(errs)
-  if (!error_check_LP(dist, G, q, iprime, errs, xhats)) {
-    return -1;
+/*
+约束(2)第i对行中一列的系数，b = bpdf(i, N, x_j)，ratio为该列的桶比r_j/q
+  相对q的因子：取整一侧乘r_j^{i+1}（LB的下界行、UB的上界行），另一侧乘(1+eps3_j)/(1+eps3)
+*/
+void LP_sweep::row2_coeffs(int64_t i, double b, double ratio, double& a_lo, double& a_hi) const {
+  a_lo = b;
+  a_hi = b;
+  if (ratio == 1.0) {
+    return;
   }
+  double f_r = pow(ratio, i+1);
+  double f_eps3 = exp(log1p_eps3(dist.N, i, q * ratio, xhats[i]) - log_eps3s[i]);
+  if (!upper) {
+    a_lo *= f_r;
+    a_hi /= f_eps3;
+  }
+  else {
+    a_lo *= f_eps3;
+    a_hi /= f_r;
+  }
+}
 
-  int64_t N = dist.N;
-  std::vector<double> eps2s(iprime+1);
-  std::vector<double> eps3s(iprime+1);
-  for (int i=0; i<=iprime; ++i) {
-    eps2s[i] = sqrt(-N * log(errs[i]) / 2.0) * ((((double) i) + 1.0) / ((double) (N - i)));
-    double log_eps3 = (N - i) * log((1 - xhats[i]) / (1 - q*xhats[i])) - (i + 1) * log(q);
-    eps3s[i] = exp(log_eps3) - 1;
+// 第j列在约束(2)(3)各行（constr_23的顺序）中的系数
+void LP_sweep::raw_coeffs(int64_t j, double* a) const {
+  int64_t iprime = log_eps3s.size() - 1;
+  int64_t n_rows = 2 * (iprime + 1) + 2;
+  for (int64_t i=0; i<=iprime; ++i) {
+    row2_coeffs(i, table->row(i)[j], ratio[j], a[2*i], a[2*i+1]);
   }
+  a[n_rows-2] = upper ? 1.0 : ratio[j];
+  a[n_rows-1] = upper ? 1.0 / ratio[j] : 1.0;
+}
 
-  int64_t l = ((int64_t) floor((log(10000.0) + log((double) N)) / log(q))) + 1;
-  std::vector<double> mesh(l);
-  mesh[l-1] = 1.0 / (10000.0 * N);
-  for (int i=l-2; i>=0; --i) {
-    mesh[i] = mesh[i+1] * q;
+// 模型中第j列的系数：聚合的列用所在那一段的放松系数
+void LP_sweep::column_coeffs(int64_t j, double* a) const {
+  if (group_of[j] < 0) {
+    raw_coeffs(j, a);
+    return;
   }
+  int64_t n_rows = 2 * (int64_t) log_eps3s.size() + 2;
+  std::copy(group_coeffs.begin() + group_of[j] * n_rows, group_coeffs.begin() + (group_of[j] + 1) * n_rows, a);
+}
 
-  double res = 1.0;
-  double lp_bound;
-  bool feasible = false;
-  for (int64_t idx=1; idx<=l+1; ++idx) {
-    lp_bound = LP_lower(dist, G, mesh, q, iprime, idx, eps2s, eps3s, xhats);
-    if (lp_bound > 0) {
-      feasible = true;
-      res = std::min(res, lp_bound);
+double LP_sweep::column_ub(int64_t j) const {
+  return (group_of[j] < 0) ? 1.0 : group_ub[group_of[j]];
+}
+
+/*
+列聚合：约束(2)(3)的系数逐行相差都不超过LP_AGG_TOL的一段连续列[a, b]（至少3列），
+  每列的系数换成这一段的放松系数：下界行（constr_23的偶数行）取段内最大值，上界行取最小值，
+  原LP的任一可行解在放松后仍可行，所以界仍然有效，变松至多LP_AGG_TOL量级
+  放松后段内各列只在目标函数和约束(1)中不同：在前缀(j < idx-1)内时系数为(1, scale/x_j)，是两端列的锥组合，
+  前缀外时完全相同。因此只要模型里有a、b、idx-1和前缀部分的最后一列idx-2，段内其余的列都是多余的，
+  这些列不进初始模型、不参与定价，由set_idx按需加入
+  段内的h_j之和由约束(3)的上界行限制，聚合的列的上界取这个和的上界（一列可能要代表整段的质量）
+*/
+void LP_sweep::aggregate() {
+  int64_t n_rows = 2 * (int64_t) log_eps3s.size() + 2;
+  group_of.assign(l, -1);
+  interior.assign(l, false);
+  double hi_3 = upper ? q : 1.0; // right-hand side of the upper row of constraint (3), without p
+  std::vector<double> a(n_rows), c_min(n_rows), c_max(n_rows);
+  int64_t s = 0;
+  raw_coeffs(0, c_min.data());
+  c_max = c_min;
+  for (int64_t j=1; j<=l; ++j) {
+    bool fits = false;
+    if (j < l) {
+      raw_coeffs(j, a.data());
+      fits = true;
+      for (int64_t k=0; k<n_rows && fits; ++k) {
+        fits = std::max(c_max[k], a[k]) - std::min(c_min[k], a[k]) <= LP_AGG_TOL;
+      }
     }
-  }
-  if (!feasible) {
-    if (dist.verbose) {
-      std::cerr << "\n[Model is infeasible! Sample might not be drawn iid from the underlying distribution.]" << std::endl;
+    if (fits) {
+      for (int64_t k=0; k<n_rows; ++k) {
+        c_min[k] = std::min(c_min[k], a[k]);
+        c_max[k] = std::max(c_max[k], a[k]);
+      }
+      continue;
+    }
+
+    // run [s, j-1]
+    if (j - 1 - s >= 2) {
+      int64_t g = group_ub.size();
+      for (int64_t t=s; t<j; ++t) {
+        group_of[t] = g;
+        interior[t] = (t > s && t < j-1);
+      }
+      for (int64_t k=0; k<n_rows; ++k) {
+        group_coeffs.push_back((k % 2 == 0) ? c_max[k] : c_min[k]);
+      }
+      group_ub.push_back(hi_3 / c_min[n_rows-1]);
+    }
+    if (j < l) {
+      s = j;
+      c_min = a;
+      c_max = a;
     }
-    return -2;
   }
-  return std::max(res, 0.0);
 }
 
-double LP_UB(dist_t& dist, int64_t G, double q, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
-  // Note: error rate will be 2 * sum(errs)
-  if (!error_check_LP(dist, G, q, iprime, errs, xhats)) {
-    return -1;
+// 第j列当前的目标函数系数和约束(1)系数
+double LP_sweep::obj_coeff(int64_t j) const {
+  if (threshold) {
+    return std::max(0.0, 1.0 - cur_mu / mesh[j]);
   }
+  return (j < cur_idx-1) ? 1.0 : 0.0;
+}
 
-  int64_t N = dist.N;
+double LP_sweep::row1_coeff(int64_t j) const {
+  return (!threshold && j < cur_idx-1) ? cur_scale / mesh[j] : 0.0;
+}
 
-  std::vector<double> eps2s(iprime+1);
-  std::vector<double> eps3s(iprime+1);
-  for (int i=0; i<=iprime; ++i) {
-    eps2s[i] = sqrt(-N * log(errs[i]) / 2.0) * ((((double) i) + 1.0) / ((double) (N - i)));
-    double log_eps3 = (N - i) * log((1 - xhats[i]) / (1 - q*xhats[i])) - (i + 1) * log(q);
-    eps3s[i] = exp(log_eps3) - 1;
+// 把第j列加进模型，目标函数和约束(1)按当前的idx（或mu）填
+void LP_sweep::add_column(int64_t j) {
+  std::vector<double> a(constr_23.size());
+  column_coeffs(j, a.data());
+  hx_vars[j] = lp->add_var(0.0, column_ub(j), obj_coeff(j));
+  if (row1_coeff(j) != 0.0) {
+    lp->set_coeff(constr_1, hx_vars[j], row1_coeff(j));
+  }
+  for (size_t k=0; k<constr_23.size(); ++k) {
+    lp->set_coeff(constr_23[k], hx_vars[j], a[k]);
   }
+  if (!interior[j]) {
+    --n_absent;
+  }
+}
 
-  int64_t l = ((int64_t) floor((log(10000.0) + log((double) N)) / log(q))) + 1;
-  std::vector<double> mesh(l);
-  mesh[l-1] = 1.0 / (10000.0 * N);
-  for (int i=l-2; i>=0; --i) {
-    mesh[i] = mesh[i+1] * q;
+// 不在模型里的第j列在对偶(y_1, y_23)下的检验数 obj_j - y^T a_j，与lp->reduced_cost同一意义；a为工作区
+double LP_sweep::reduced_cost(int64_t j, double y_1, const std::vector<double>& y_23, std::vector<double>& a) const {
+  column_coeffs(j, a.data());
+  double d = obj_coeff(j) - y_1 * row1_coeff(j);
+  for (size_t k=0; k<y_23.size(); ++k) {
+    d -= y_23[k] * a[k];
   }
+  return d;
+}
 
-  double res = 0.0;
-  double lp_bound;
-  bool feasible = false;
-  for (int64_t idx=1; idx<=l+1; ++idx) {
-    lp_bound = LP_upper(dist, G, mesh, q, iprime, idx, eps2s, eps3s, xhats);
-    if (lp_bound > 0) {
-      feasible = true;
-      res = std::max(res, lp_bound);
-    }
+/*
+求解当前模型，返回LP_OPTIMAL等状态；所有列都在模型里时就是lp->solve()
+列生成：主问题最优后对其余的列定价，最小化意义下检验数小于-LP_CG_TOL的取最小的LP_CG_BATCH列加进来再解；
+  主问题最优值加上其余各列的 min(0, d_j)（乘上h_j的上界）是整个LP的拉格朗日界，已经不比cutoff好时返回LP_CUTOFF；
+  主问题本身不设cutoff（它的最优值不是整个LP的界）
+  主问题不可行时其余的列全部加进来（不做Farkas定价），之后就是完整的LP
+feasibility为true时只关心可行性，主问题可行就返回
+*/
+int LP_sweep::optimize(double cutoff, bool feasibility) {
+  int status = solve_model(cutoff, feasibility);
+  // a loose tolerance can end phase 1 early, infeasibility is confirmed at the strict tolerance
+  if (status == LP_INFEASIBLE && dist.lp_tolerance > LP_STRICT_TOL) {
+    lp->set_tolerance(LP_STRICT_TOL);
+    status = solve_model(cutoff, feasibility);
+    lp->set_tolerance(dist.lp_tolerance);
   }
-  if (!feasible) {
-    if (dist.verbose) {
-      std::cerr << "\n[Model is infeasible! Sample might not be drawn iid from the underlying distribution.]" << std::endl;
+  return status;
+}
+
+int LP_sweep::solve_model(double cutoff, bool feasibility) {
+  if (n_absent == 0) {
+    lp->set_cutoff(cutoff);
+    int status = solve_counted(*lp);
+    return status;
+  }
+
+  lp->set_cutoff(std::numeric_limits<double>::infinity());
+  double sign = upper ? -1.0 : 1.0; // to the minimization sense
+  std::vector<double> a(constr_23.size());
+  std::vector<double> y_23(constr_23.size());
+  std::vector<std::pair<double, int64_t>> enter;
+  while (true) {
+    int status = solve_counted(*lp);
+    if (status == LP_INFEASIBLE && n_absent > 0) {
+      for (int64_t j=0; j<l; ++j) {
+        if (hx_vars[j] < 0 && !interior[j]) {
+          add_column(j);
+        }
+      }
+      lp->set_cutoff(cutoff);
+      continue;
+    }
+    if (status != LP_OPTIMAL || feasibility || n_absent == 0) {
+      return status;
+    }
+
+    double y_1 = (constr_1 >= 0) ? lp->dual(constr_1) : 0.0;
+    for (size_t k=0; k<constr_23.size(); ++k) {
+      y_23[k] = lp->dual(constr_23[k]);
+    }
+    double bound = sign * lp->objective();
+    enter.clear();
+    for (int64_t j=0; j<l; ++j) {
+      if (hx_vars[j] >= 0 || interior[j]) {
+        continue;
+      }
+      double d = sign * reduced_cost(j, y_1, y_23, a);
+      if (d < 0.0) {
+        bound += d * column_ub(j);
+        if (d < -LP_CG_TOL) {
+          enter.push_back({d, j});
+        }
+      }
+    }
+    if (enter.empty()) {
+      return LP_OPTIMAL;
+    }
+    double min_cutoff = sign * cutoff;
+    if (std::isfinite(cutoff) && bound - min_cutoff > LP_CG_TOL * (1.0 + fabs(min_cutoff))) {
+      return LP_CUTOFF;
+    }
+
+    int64_t batch = std::min<int64_t>(LP_CG_BATCH, enter.size());
+    prof_count("columns priced in", batch);
+    std::partial_sort(enter.begin(), enter.begin() + batch, enter.end());
+    for (int64_t t=0; t<batch; ++t) {
+      add_column(enter[t].second);
     }
-    return -2;
   }
-  return std::min(res, 1.0);
 }
 
-double LP_LB(dist_t& dist, int64_t G, double err) {
-  return LP_LB_normal(dist, G, err);
+// h_j x_j和它们的检验数，在solve返回最优值之后调用；不在模型里的列h_j为0，检验数按对偶定价
+void LP_sweep::solution(std::vector<double>& hx, std::vector<double>& rc) {
+  hx.resize(l);
+  rc.resize(l);
+  std::vector<double> a(constr_23.size());
+  std::vector<double> y_23(constr_23.size());
+  double y_1 = 0.0;
+  if (n_absent > 0 || group_ub.size() > 0) {
+    y_1 = (constr_1 >= 0) ? lp->dual(constr_1) : 0.0;
+    for (size_t k=0; k<constr_23.size(); ++k) {
+      y_23[k] = lp->dual(constr_23[k]);
+    }
+  }
+  for (int64_t j=0; j<l; ++j) {
+    if (hx_vars[j] < 0) {
+      hx[j] = 0.0;
+      rc[j] = reduced_cost(j, y_1, y_23, a);
+    }
+    else {
+      hx[j] = lp->value(hx_vars[j]);
+      rc[j] = lp->reduced_cost(hx_vars[j]);
+    }
+  }
 }
 
-double LP_UB(dist_t& dist, int64_t G, double err) {
-  return LP_UB_normal(dist, G, err);
+/*
+对偶证书：在solve返回最优值之后调用，用求解器给出的对偶y算出整个LP（包括没进模型的列）的拉格朗日界
+  min c^T x, lo <= Ax <= hi, 0 <= x <= u：对任意y，c^T x = d^T x + y^T Ax，d = c - A^T y，
+  所以最优值 >= sum_j min_{0<=x_j<=u_j} d_j x_j + sum_r min_{lo_r<=s_r<=hi_r} y_r s_r（max时取max、不等号反向）
+  y_r的符号使对应的项无界时（比如min时>=行的y_r < 0）把y_r换成0，界仍然成立
+  d_j用普通浮点运算求和，再按先验误差界 gamma_2m * sum|y_r a_r| 向外放宽；其余的乘加每步向外推一个ulp，
+  得到的界对模型里的这些浮点系数严格成立，与求解器的容差和最优性无关；对偶越接近最优，界越接近最优值
+  证书只覆盖最优值，LP不可行的判断（-2和可行范围的二分）仍然来自求解器
+*/
+static double round_down(double x) {
+  return std::nextafter(x, -std::numeric_limits<double>::infinity());
 }
 
-// Fast version with q=1.008,iprime=6
-double LP_LB_fast(dist_t& dist, int64_t G, double err) {
-  if (!error_check_basic(dist, G, err)) {
-    return -1;
-  }
-  double q = 1.008;
-  int64_t iprime = 6;
-  std::vector<double> xhats = {3.0/dist.N, 4.0/dist.N, 5.0/dist.N, 6.0/dist.N, 7.0/dist.N, 8.0/dist.N, 9.0/dist.N};
-  std::vector<double> errs = {1, 1.5, 1.75, 1.875, 1.9375, 1.96875, 1.984375};
-  double sum = std::accumulate(errs.begin(), errs.end(), 0.0);
-  for (auto& x:errs) {
-    x *= (err / (2.0 * sum));
-  }
-  return LP_LB(dist, G, q, iprime, errs, xhats);
+static double round_up(double x) {
+  return std::nextafter(x, std::numeric_limits<double>::infinity());
 }
 
-double LP_UB_fast(dist_t& dist, int64_t G, double err) {
-  if (!error_check_basic(dist, G, err)) {
-    return -1;
+double LP_sweep::certified_bound() {
+  prof_span span("certificate");
+  const double inf = std::numeric_limits<double>::infinity();
+  // rows and their bounds: constraints (2)(3), then (1) and (4) outside the threshold form
+  std::vector<int> rows(constr_23);
+  std::vector<double> lo(row_lo), hi(row_hi);
+  if (!threshold) {
+    rows.push_back(constr_1);
+    lo.push_back(G * cur_scale);
+    hi.push_back(G * cur_scale);
+    rows.push_back(constr_4);
+    lo.push_back(-inf);
+    hi.push_back(0.0);
   }
-  double q = 1.008;
-  int64_t iprime = 6;
-  std::vector<double> xhats = {3.0/dist.N, 4.0/dist.N, 5.0/dist.N, 6.0/dist.N, 7.0/dist.N, 8.0/dist.N, 9.0/dist.N};
-  std::vector<double> errs = {1, 1.5, 1.75, 1.875, 1.9375, 1.96875, 1.984375};
-  double sum = std::accumulate(errs.begin(), errs.end(), 0.0);
-  for (auto& x:errs) {
-    x *= (err / (2.0 * sum));
+  int64_t n_rows = rows.size();
+  int64_t n_23 = constr_23.size();
+  std::vector<double> y(n_rows);
+  for (int64_t r=0; r<n_rows; ++r) {
+    y[r] = lp->dual(rows[r]);
+    bool unbounded = upper ? (y[r] > 0 && hi[r] == inf) || (y[r] < 0 && lo[r] == -inf)
+                           : (y[r] > 0 && lo[r] == -inf) || (y[r] < 0 && hi[r] == inf);
+    if (unbounded || !std::isfinite(y[r])) {
+      y[r] = 0.0;
+    }
   }
-  return LP_UB(dist, G, q, iprime, errs, xhats);
-}
 
-// Normal version with q=1.004, iprime=6
-double LP_LB_normal(dist_t& dist, int64_t G, double err) {
-  if (!error_check_basic(dist, G, err)) {
-    return -1;
+  // [d_lo, d_hi] = obj - sum_r y_r a_r, then the best term of a variable in [0, u]
+  double total = 0.0;
+  auto add = [&](double term) { total = upper ? round_up(total + term) : round_down(total + term); };
+  // d_j is summed in plain arithmetic; m products and sums err by at most gamma_2m * sum |terms| plus m underflows
+  int64_t m = n_23 + 2;
+  double u_roundoff = std::numeric_limits<double>::epsilon() / 2;
+  double gamma = round_up(2 * (m + 1) * u_roundoff / (1 - 2 * (m + 1) * u_roundoff));
+  double underflow = m * std::numeric_limits<double>::denorm_min();
+  auto add_column = [&](double obj, const double* a, double a_1, double a_4, double u) {
+    double d = obj, mag = fabs(obj);
+    for (int64_t k=0; k<n_23; ++k) {
+      double prod = y[k] * a[k];
+      d -= prod;
+      mag += fabs(prod);
+    }
+    if (!threshold) {
+      d -= y[n_23] * a_1 + y[n_23+1] * a_4;
+      mag += fabs(y[n_23] * a_1) + fabs(y[n_23+1] * a_4);
+    }
+    double err = round_up(gamma * mag + underflow);
+    double d_lo = round_down(d - err), d_hi = round_up(d + err);
+    if (upper && d_hi > 0) {
+      add(round_up(d_hi * u));
+    }
+    if (!upper && d_lo < 0) {
+      add(round_down(d_lo * u));
+    }
+  };
+  std::vector<double> a(n_23);
+  for (int64_t j=0; j<l; ++j) {
+    column_coeffs(j, a.data());
+    add_column(obj_coeff(j), a.data(), row1_coeff(j), (!threshold && j == cur_idx-1 && cur_idx <= l) ? -1.0 : 0.0, column_ub(j));
+  }
+  add_column(0.0, p_coeffs.data(), 0.0, 0.0, 1.0);
+  if (!threshold) {
+    std::vector<double> zero(n_23, 0.0);
+    add_column((upper || cur_idx <= l) ? 1.0 : 0.0, zero.data(), cur_c_row1, (cur_idx <= l) ? 1.0 : 0.0, 1.0);
   }
 
-  double q = 1.004;
-  int64_t iprime = 6;
-  std::vector<double> xhats = {3.0/dist.N, 4.0/dist.N, 5.0/dist.N, 6.0/dist.N, 7.0/dist.N, 8.0/dist.N, 9.0/dist.N};
-  std::vector<double> errs = {1, 1.5, 1.75, 1.875, 1.9375, 1.96875, 1.984375};
-  double sum = std::accumulate(errs.begin(), errs.end(), 0.0);
-  for (auto& x:errs) {
-    x *= (err / (2.0 * sum));
+  // y_r s_r at the end of [lo_r, hi_r] that is worst for the bound
+  for (int64_t r=0; r<n_rows; ++r) {
+    if (y[r] == 0.0) {
+      continue;
+    }
+    double s = ((y[r] > 0) == upper) ? hi[r] : lo[r];
+    add(upper ? round_up(y[r] * s) : round_down(y[r] * s));
   }
-  return LP_LB(dist, G, q, iprime, errs, xhats);
+  return total;
 }
 
-double LP_UB_normal(dist_t& dist, int64_t G, double err) {
-  if (!error_check_basic(dist, G, err)) {
-    return -1;
+// 求解器返回LP_CUTOFF时，用证明它的对偶算证书，证书本身也不比cutoff好时才算数；没有对偶（Gurobi）时不算数
+bool LP_sweep::certified_cutoff(double cutoff) {
+  try {
+    double bound = certified_bound();
+    return upper ? bound <= cutoff : bound >= cutoff;
+  } catch(const lp_error& e) {
+    return false;
   }
+}
 
-  double q = 1.004;
-  int64_t iprime = 6;
-  std::vector<double> xhats = {3.0/dist.N, 4.0/dist.N, 5.0/dist.N, 6.0/dist.N, 7.0/dist.N, 8.0/dist.N, 9.0/dist.N};
-  std::vector<double> errs = {1, 1.5, 1.75, 1.875, 1.9375, 1.96875, 1.984375};
-  double sum = std::accumulate(errs.begin(), errs.end(), 0.0);
-  for (auto& x:errs) {
-    x *= (err / (2.0 * sum));
+void LP_sweep::set_G(int64_t new_G) {
+  if (new_G != G) {
+    G = new_G;
+    cur_scale = 0.0; // forces set_idx to rewrite constraint (1)
   }
-  return LP_UB(dist, G, q, iprime, errs, xhats);
 }
 
-// Slow version with q=1.002,iprime=4,err=0.01置信度为99%
-double LP_LB_slow(dist_t& dist, int64_t G, double err=0.01) {
-  if (!error_check_basic(dist, G, err)) {
-    return -1;
+void LP_sweep::set_eps2(const std::vector<double>& new_eps2s) {
+  const double inf = std::numeric_limits<double>::infinity();
+  for (size_t i=0; i<eps2s.size(); ++i) {
+    if (new_eps2s[i] == eps2s[i]) {
+      continue;
+    }
+    eps2s[i] = new_eps2s[i];
+    double lo, hi;
+    row2_bounds(i, eps2s[i], lo, hi);
+    lp->set_row_bounds(constr_23[2*i], lo, inf);
+    lp->set_row_bounds(constr_23[2*i+1], -inf, hi);
+    row_lo[2*i] = lo;
+    row_hi[2*i+1] = hi;
   }
+}
 
-  double q = 1.002;
-  int64_t iprime = 4;
-  std::vector<double> xhats = {7.0/dist.N, 11.0/dist.N, 14.0/dist.N, 16.3/dist.N, 18.5/dist.N};
-  std::vector<double> errs = {0.00009, 0.000165, 0.00175, 0.00175, 0.0012};
-  // double sum = std::accumulate(errs.begin(), errs.end(), 0.0);
-  // for (auto& x:errs) {
-  //   x *= (err / (2.0 * sum));
-  // }
-  return LP_LB(dist, G, q, iprime, errs, xhats);
+/*
+约束(1)放松成单边的可行性检查，目标函数不变、不设cutoff
+  below为true: sum_{j<idx-1} h_j/x_j + c/x_{idx-1} <= G 是否可行（c取0即可，左边最小为 min_P sum_{j<idx-1} h_j/x_j）
+  below为false: >= G 是否可行（c取h_{idx-1}，左边最大为 max_P sum_{j<idx} h_j/x_j）
+两者都可行时LP(idx)可行，见LP_sweep_all；lp_error直接抛出
+*/
+bool LP_sweep::row1_feasible(int64_t idx, bool below) {
+  const double inf = std::numeric_limits<double>::infinity();
+  set_idx(idx);
+  double rhs = G * cur_scale;
+  lp->set_row_bounds(constr_1, below ? -inf : rhs, below ? rhs : inf);
+  int status = optimize(inf, true);
+  lp->set_row_bounds(constr_1, rhs, rhs);
+  return status != LP_INFEASIBLE;
 }
 
-double LP_UB_slow(dist_t& dist, int64_t G, double err=0.01) {
-  if (!error_check_basic(dist, G, err)) {
-    return -1;
+// 单个idx的求解：建一个LP_sweep模型并只求解这一个idx
+static double LP_single(dist_t& dist, int64_t G, std::vector<double>& mesh, double q, int64_t iprime, int64_t idx, std::vector<double>& eps2s, std::vector<double>& eps3s, std::vector<double>& xhats, bool upper) {
+  try {
+    LP_sweep sweep(dist, G, mesh, q, iprime, eps2s, eps3s, xhats, upper);
+    return sweep.solve(idx);
+  } catch(const lp_error& e) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: code = " << e.code << "; message: " << e.what() << ".]" << std::endl;
+    }
+    return -3;
+  } catch(...) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: Exception during optimization.]" << std::endl;
+    }
+    return -4;
   }
-
-  double q = 1.002;
-  int64_t iprime = 4;
-  std::vector<double> xhats = {7.0/dist.N, 11.0/dist.N, 14.0/dist.N, 16.3/dist.N, 18.5/dist.N};
-  std::vector<double> errs = {0.00009, 0.000165, 0.00175, 0.00175, 0.0012};
-  // double sum = std::accumulate(errs.begin(), errs.end(), 0.0);
-  // for (auto& x:errs) {
-  //   x *= (err / (2.0 * sum));
-  // }
-  return LP_UB(dist, G, q, iprime, errs, xhats);
 }
 
+/*
+@ parameters:
+  dist表F^S，G为猜测次数
+  mesh对应X_l表网络，q为网络精度参数
+  iprime对应i'，用于区分高频和低频元素，idx为攻击者在网格上的猜测范围
+*/
+double LP_lower(dist_t& dist, int64_t G, std::vector<double>& mesh, double q, int64_t iprime, int64_t idx, std::vector<double>& eps2s, std::vector<double>& eps3s, std::vector<double>& xhats) {
+  return LP_single(dist, G, mesh, q, iprime, idx, eps2s, eps3s, xhats, false);
+}
+
+double LP_upper(dist_t& dist, int64_t G, std::vector<double>& mesh, double q, int64_t iprime, int64_t idx, std::vector<double>& eps2s, std::vector<double>& eps3s, std::vector<double>& xhats) {
+  return LP_single(dist, G, mesh, q, iprime, idx, eps2s, eps3s, xhats, true);
+}
+
+// 几何网格：mesh[l-1] = 1/(10000N)，mesh[i] = mesh[i+1] * q，递减到不超过1
+static std::vector<double> make_mesh(int64_t N, double q) {
+  int64_t l = ((int64_t) floor((log(10000.0) + log((double) N)) / log(q))) + 1;
+  std::vector<double> mesh(l);
+  mesh[l-1] = 1.0 / (10000.0 * N);
+  for (int i=l-2; i>=0; --i) {
+    mesh[i] = mesh[i+1] * q;
+  }
+  return mesh;
+}
+
+/*
+idx扫描：对一组G同时扫描idx（G的参数族）。需要求解的(idx, G)按idx切成固定数量的块并行求解，
+每个块在线程内新建一个LP_sweep，块内逐个idx、在每个idx上逐个G求解，G的方向每个idx反转一次，
+相邻两次求解总是只差一个idx或一个G，都从上一次的最优基热启动。
+块的划分与线程数无关，因此并行结果与单线程逐位相同，单个G时就是原来的单G扫描
+
+剪枝（都是严格的，不改变最终的min/max），每个G分别进行：
+  可行区间：约束(2)(3)与idx无关，记其可行域为P，LP(idx)可行当且仅当
+    min_P sum_{j<idx-1} h_j/x_j <= G <= max_P sum_{j<idx} h_j/x_j，
+  两边都随idx单调不减，所以可行的idx是[1,l]中的一段区间，两端用row1_feasible二分查找，区间外不求解；
+  G*x_{idx-1}超过总质量（LB为1，UB为q）时右边的max一定小于G，二分之前直接排除
+  目标下界：LB中约束(1)的 x_j >= x_{idx-1} 给出 LP(idx) >= G*x_{idx-1}，不小于当前最优值的idx直接跳过
+  cutoff：其余的LP把当前最优值交给求解器，证明不会更好时提前停止
+当前最优值只来自每个G串行的几个探测LP和本块已解的LP，剪枝与线程数无关，并行结果仍与单线程逐位相同
+*/
+static const int64_t LP_SWEEP_BLOCKS = 64;
+static const int64_t LP_SWEEP_PROBES = 8; // idx solved serially to seed the incumbent
+static const int64_t LP_RANGE_MARGIN = 1; // idx kept on each side of the bisected feasible range
+
+static std::atomic<int64_t> stat_sweeps(0);
+static std::atomic<int64_t> stat_idx_total(0);
+static std::atomic<int64_t> stat_solved(0);
+static std::atomic<int64_t> stat_infeasible(0);
+static std::atomic<int64_t> stat_range_pruned(0);
+static std::atomic<int64_t> stat_cutoff_pruned(0);
+static std::atomic<int64_t> stat_columns(0);
+static std::atomic<int64_t> stat_aggregated(0);
+
+/*
+单个G的串行部分：二分出可行区间，在区间内均匀取几个idx求解作为初始最优值
+  todo返回还需要扫描的idx（不含已探测的，LB中也不含被目标下界排除的）
+  res_min/res_max/any_feasible为探测的结果，best_idx为取到最优值的idx，idx_solved等计数累加
+  best_idx传入时大于0表示提示（例如上一个网格上最优的idx），先求解它作为初始最优值
+  probe为这个G、这一侧的模型（已经设好G和eps2s），同一个G的多个err共用它
+*/
+static void LP_sweep_prepare(LP_sweep& probe, int64_t G, std::vector<double>& mesh, bool upper,
+                             std::vector<int64_t>& todo, double& res_min, double& res_max, bool& any_feasible, int64_t& best_idx, int64_t& idx_solved, int64_t& solved, int64_t& infeasible, int64_t& cutoff_pruned) {
+  const double inf = std::numeric_limits<double>::infinity();
+  int64_t l = mesh.size();
+  double cap = upper ? probe.max_ratio() : 1.0; // upper bound of sum h_j from constraint (3)
+
+  int64_t first = 1;
+  while (first <= l && G * mesh[first-1] > cap) {
+    ++first;
+  }
+  int64_t last = l;
+  ++solved;
+  if (first > l || !probe.row1_feasible(l, false)) {
+    last = 0;
+  }
+  else {
+    int64_t a = first, b = l; // smallest idx that can reach G
+    while (a < b) {
+      int64_t mid = (a + b) / 2;
+      ++solved;
+      if (probe.row1_feasible(mid, false)) {
+        b = mid;
+      }
+      else {
+        a = mid + 1;
+      }
+    }
+    first = a;
+    ++solved;
+    if (!probe.row1_feasible(first, true)) {
+      last = 0;
+    }
+    else {
+      b = l; // largest idx that can stay below G
+      while (a < b) {
+        int64_t mid = (a + b + 1) / 2;
+        ++solved;
+        if (probe.row1_feasible(mid, true)) {
+          a = mid;
+        }
+        else {
+          b = mid - 1;
+        }
+      }
+      last = a;
+    }
+  }
+  todo.clear();
+  if (first <= last) {
+    first = std::max<int64_t>(first - LP_RANGE_MARGIN, 1);
+    last = std::min(last + LP_RANGE_MARGIN, l);
+    for (int64_t idx=first; idx<=last; ++idx) {
+      todo.push_back(idx);
+    }
+  }
+  todo.push_back(l+1); // not covered by the argument above, always solved
+
+  // the hinted idx and evenly spaced probes, solved on the warm probe model and removed from todo
+  int64_t n_probes = std::min<int64_t>(LP_SWEEP_PROBES, todo.size());
+  std::vector<int64_t> probes;
+  auto hint = std::find(todo.begin(), todo.end(), best_idx);
+  if (hint != todo.end()) {
+    probes.push_back(hint - todo.begin());
+  }
+  best_idx = 0;
+  for (int64_t t=0; t<n_probes; ++t) {
+    int64_t k = (2 * t + 1) * todo.size() / (2 * n_probes);
+    if (probes.empty() || k != probes[0]) {
+      probes.push_back(k);
+    }
+  }
+  std::vector<bool> probed(todo.size(), false);
+  for (auto k:probes) {
+    double cutoff = any_feasible ? (upper ? res_max : res_min) : inf;
+    double lp_bound = probe.solve(todo[k], cutoff);
+    probed[k] = true;
+    ++idx_solved;
+    ++solved;
+    infeasible += (lp_bound == -2);
+    cutoff_pruned += (lp_bound == -5);
+    if (lp_bound > 0) {
+      if (!any_feasible || (upper ? lp_bound > res_max : lp_bound < res_min)) {
+        best_idx = todo[k];
+      }
+      any_feasible = true;
+      res_min = std::min(res_min, lp_bound);
+      res_max = std::max(res_max, lp_bound);
+    }
+  }
+  std::vector<int64_t> rest;
+  for (int64_t k=0; k<(int64_t) todo.size(); ++k) {
+    // LB: G*x_{idx-1} is decreasing in idx, so this drops a prefix of the range
+    bool dominated = !upper && any_feasible && todo[k] <= l && G * mesh[todo[k]-1] >= res_min;
+    if (!probed[k] && !dominated) {
+      rest.push_back(todo[k]);
+    }
+  }
+  todo.swap(rest);
+}
+
+// 求解设置中改变LP值的部分，加在缓存和检查点的键里：对偶证书、求解器容差、缩放
+static std::string LP_solve_mode(dist_t& dist) {
+  std::ostringstream mode;
+  mode << std::hexfloat << (dist.certify ? " certified" : "") << (dist.lp_scaling ? "" : " unscaled");
+  if (dist.lp_tolerance > 0) {
+    mode << " tol=" << dist.lp_tolerance;
+  }
+  return mode.str();
+}
+
+// 检查点的键：数据集、各job的G、LB/UB和eps2s，以及网格、eps3s、xhats和分块（由可行范围决定）；长的部分只记哈希
+static std::string LP_sweep_key(dist_t& dist, std::vector<int64_t>& Gs, std::vector<int64_t>& level, std::vector<double>& mesh, double q, int64_t iprime, std::vector<std::vector<double>>& eps2_sets, std::vector<double>& eps3s, std::vector<double>& xhats, std::vector<char>& upper, std::vector<std::vector<int64_t>>& idx_list, std::vector<int64_t>& block_first) {
+  std::ostringstream key, mesh_text, layout;
+  key << std::hex << fingerprint(dist) << std::dec << std::hexfloat << " q=" << q << " iprime=" << iprime << " xhats=";
+  for (auto x:xhats) {
+    key << x << ",";
+  }
+  key << " eps3s=";
+  for (auto x:eps3s) {
+    key << x << ",";
+  }
+  for (int64_t g=0; g<(int64_t) Gs.size(); ++g) {
+    key << (upper[g] ? " UB " : " LB ") << Gs[g] << " eps2s=";
+    for (auto x:eps2_sets[level[g]]) {
+      key << x << ",";
+    }
+  }
+  mesh_text << std::hexfloat;
+  for (auto x:mesh) {
+    mesh_text << x << ",";
+  }
+  for (int side=0; side<2; ++side) {
+    for (auto idx:idx_list[side]) {
+      layout << idx << ",";
+    }
+    layout << ";";
+  }
+  for (auto t:block_first) {
+    layout << t << ",";
+  }
+  key << LP_solve_mode(dist) << std::hex << " mesh=" << hash_string(mesh_text.str()) << " blocks=" << hash_string(layout.str());
+  return key.str();
+}
+
+/*
+@ parameters:
+  Gs为一组猜测次数，任意顺序，内部按G从小到大处理；upper[g]为true时Gs[g]求UB，否则求LB，
+  同一个G可以同时出现在两边（LP_bounds），两边共用网格和eps，在同一个并行区域里扫描
+  res[g]为Gs[g]对应的min (LB) 或 max (UB)，feasible[g]表示是否有可行的idx，best_idx[g]为取到res[g]的idx，
+  传入时非空则为每个G先探测的idx（0表示没有）
+  Gs[g]按eps2_sets[level[g]]求解（多个err，见LP_curve_levels）：每个idx上各组按从松到紧的顺序、组内按G蛇形求解，
+    相邻两次求解只差一个G或一组eps2s，块内的模型用set_eps2切换；
+    eps2s逐项不小于另一组时，约束(2)更松、可行域更大，同一个idx上LB的LP值不大于、UB的LP值不小于另一组的，
+    较松一组在这个idx上不可行、或者它的值已经不能改进同一个G较紧一组的当前最优值时，较紧的一组跳过这个idx
+返回false表示求解器出错
+*/
+static bool LP_sweep_curve(dist_t& dist, std::vector<int64_t>& Gs, std::vector<int64_t>& level, std::vector<double>& mesh, double q, int64_t iprime, std::vector<std::vector<double>>& eps2_sets, std::vector<double>& eps3s, std::vector<double>& xhats, std::vector<char>& upper, std::vector<double>& res, std::vector<bool>& feasible, std::vector<int64_t>& best_idx) {
+  prof_span span("LP sweep", "Gs", (double) Gs.size());
+  const double inf = std::numeric_limits<double>::infinity();
+  int64_t l = mesh.size();
+  int64_t n_G = Gs.size();
+
+  // looser[a * n_levels + b]: every eps2 of level a is at least that of level b; rank orders the levels loosest first
+  int64_t n_levels = eps2_sets.size();
+  std::vector<char> looser(n_levels * n_levels);
+  std::vector<double> eps2_sum(n_levels);
+  for (int64_t a=0; a<n_levels; ++a) {
+    eps2_sum[a] = std::accumulate(eps2_sets[a].begin(), eps2_sets[a].end(), 0.0);
+    for (int64_t b=0; b<n_levels; ++b) {
+      looser[a * n_levels + b] = true;
+      for (int64_t i=0; i<=iprime; ++i) {
+        looser[a * n_levels + b] = looser[a * n_levels + b] && eps2_sets[a][i] >= eps2_sets[b][i];
+      }
+    }
+  }
+  std::vector<int64_t> rank(n_levels);
+  std::iota(rank.begin(), rank.end(), 0);
+  std::stable_sort(rank.begin(), rank.end(), [&](int64_t a, int64_t b) { return eps2_sum[a] > eps2_sum[b]; });
+  std::vector<int64_t> rank_of(n_levels);
+  for (int64_t r=0; r<n_levels; ++r) {
+    rank_of[rank[r]] = r;
+  }
+
+  std::vector<int64_t> order(n_G); // positions of Gs, loosest level first, then in increasing G
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](int64_t a, int64_t b) { return (level[a] != level[b]) ? rank_of[level[a]] < rank_of[level[b]] : Gs[a] < Gs[b]; });
+
+  std::vector<double> res_min(n_G, 1.0);
+  std::vector<double> res_max(n_G, 0.0);
+  std::vector<char> any_feasible(n_G, false);
+  best_idx.resize(n_G, 0);
+  std::vector<std::vector<int64_t>> todo(n_G);
+  std::vector<int64_t> idx_solved(n_G, 0);
+  bool failed = false;
+  int64_t solved = 0, infeasible = 0, cutoff_pruned = 0;
+
+  populate_logs(dist.N); // bpdf grows the shared log table lazily, fill it before the threads start
+  good_turing_estimates(dist, iprime+1); // same for the Good-Turing array in dist
+
+  // per G and side: feasible range and probes, independent of each other; the levels of one G share a probe model
+  std::vector<std::vector<int64_t>> groups;
+  for (auto g:order) {
+    auto same = [&](std::vector<int64_t>& group) { return Gs[group[0]] == Gs[g] && upper[group[0]] == upper[g]; };
+    auto it = std::find_if(groups.begin(), groups.end(), same);
+    if (it == groups.end() || level[it->back()] == level[g]) { // a repeated G gets its own probe model
+      groups.push_back({g});
+    }
+    else {
+      it->push_back(g);
+    }
+  }
+  int64_t n_groups = groups.size();
+  std::vector<int64_t> looser_job(n_G, -1); // the job of the same G and side one level looser
+  for (auto& group:groups) {
+    for (size_t t=1; t<group.size(); ++t) {
+      if (looser[level[group[t-1]] * n_levels + level[group[t]]]) {
+        looser_job[group[t]] = group[t-1];
+      }
+    }
+  }
+  thread_split probe_split = split_threads(dist, n_groups, "sweep probes");
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(probe_split.outer) reduction(+:solved,infeasible,cutoff_pruned)
+  for (int64_t k=0; k<n_groups; ++k) {
+    thread_job job(probe_split);
+    prof_span span("sweep probe", "group", (double) k);
+    try {
+      int64_t g0 = groups[k][0];
+      LP_sweep probe(dist, Gs[g0], mesh, q, iprime, eps2_sets[level[g0]], eps3s, xhats, upper[g0]);
+      stat_columns += l;
+      stat_aggregated += probe.aggregated();
+      for (auto g:groups[k]) {
+        bool feasible_g = false;
+        probe.set_eps2(eps2_sets[level[g]]);
+        LP_sweep_prepare(probe, Gs[g], mesh, upper[g], todo[g], res_min[g], res_max[g], feasible_g, best_idx[g], idx_solved[g], solved, infeasible, cutoff_pruned);
+        any_feasible[g] = feasible_g;
+      }
+    } catch(const lp_error& e) {
+      #pragma omp atomic write
+      failed = true;
+      if (dist.verbose) {
+        #pragma omp critical
+        std::cerr << "\n[Error: code = " << e.code << "; message: " << e.what() << ".]" << std::endl;
+      }
+    }
+  }
+  if (failed) {
+    return false;
+  }
+
+  // (idx, G) pairs left, grouped by side and idx; the jobs of one idx are listed loosest level first, then in increasing G
+  std::vector<std::vector<int64_t>> idx_list(2);
+  std::vector<std::vector<std::vector<int64_t>>> G_of_idx(2, std::vector<std::vector<int64_t>>(l + 2));
+  for (auto g:order) {
+    for (auto idx:todo[g]) {
+      G_of_idx[upper[g]][idx].push_back(g);
+    }
+  }
+  for (int side=0; side<2; ++side) {
+    for (int64_t idx=1; idx<=l+1; ++idx) {
+      if (!G_of_idx[side][idx].empty()) {
+        idx_list[side].push_back(idx);
+      }
+    }
+  }
+
+  std::vector<double> seed(n_G);
+  for (int64_t g=0; g<n_G; ++g) {
+    seed[g] = upper[g] ? res_max[g] : res_min[g];
+  }
+  // blocks of consecutive idx of one side, LB and UB blocks share the parallel loop
+  std::vector<int> block_side;
+  std::vector<int64_t> block_first, block_last;
+  for (int side=0; side<2; ++side) {
+    int64_t n_idx = idx_list[side].size();
+    int64_t n_side = std::min(LP_SWEEP_BLOCKS, n_idx);
+    for (int64_t b=0; b<n_side; ++b) {
+      block_side.push_back(side);
+      block_first.push_back(b * n_idx / n_side);
+      block_last.push_back((b + 1) * n_idx / n_side);
+    }
+  }
+  int64_t n_blocks = block_side.size();
+
+  // block results, combined in block order afterwards
+  std::vector<double> block_min(n_blocks * n_G, 1.0);
+  std::vector<double> block_max(n_blocks * n_G, 0.0);
+  std::vector<int64_t> block_idx(n_blocks * n_G, 0);
+  std::vector<char> block_feasible(n_blocks * n_G, false);
+  std::vector<int64_t> block_solved(n_blocks * n_G, 0);
+
+  // blocks finished or interrupted in an earlier run continue from their checkpointed state, see sweep_checkpoint.hpp
+  sweep_checkpoint ckpt;
+  bool checkpointing = checkpoint_enabled(dist);
+  auto interval = std::chrono::duration<double>(dist.checkpoint_interval);
+  if (checkpointing) {
+    init_checkpoint(dist, ckpt, LP_sweep_key(dist, Gs, level, mesh, q, iprime, eps2_sets, eps3s, xhats, upper, idx_list, block_first), n_G, block_first, block_last);
+    load_checkpoint(dist, ckpt);
+  }
+
+  thread_split block_split = split_threads(dist, n_blocks, "sweep blocks");
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(block_split.outer) reduction(+:solved,infeasible,cutoff_pruned)
+  for (int64_t b=0; b<n_blocks; ++b) {
+    thread_job job(block_split);
+    prof_span span("sweep block", "block", (double) b);
+    bool side = block_side[b];
+    int64_t first = block_first[b];
+    int64_t last = block_last[b];
+    std::vector<char> have_best(any_feasible);
+    std::vector<double> best(seed);
+    double* bmin = &block_min[b * n_G];
+    double* bmax = &block_max[b * n_G];
+    int64_t* bidx = &block_idx[b * n_G];
+    char* bfeasible = &block_feasible[b * n_G];
+    int64_t* bsolved = &block_solved[b * n_G];
+    std::vector<int64_t> stamp(n_G, 0); // idx at which bound_at[g] was found
+    std::vector<double> bound_at(n_G, 0.0);
+    bool reverse = false;
+    if (checkpointing && ckpt.blocks[b].started) {
+      sweep_block_state& st = ckpt.blocks[b];
+      std::copy(st.bmin.begin(), st.bmin.end(), bmin);
+      std::copy(st.bmax.begin(), st.bmax.end(), bmax);
+      std::copy(st.bidx.begin(), st.bidx.end(), bidx);
+      std::copy(st.bfeasible.begin(), st.bfeasible.end(), bfeasible);
+      std::copy(st.bsolved.begin(), st.bsolved.end(), bsolved);
+      have_best = st.have_best;
+      best = st.best;
+      reverse = st.reverse;
+      first = st.next;
+    }
+    auto last_publish = std::chrono::steady_clock::now();
+    auto publish = [&](int64_t next, bool done) {
+      #pragma omp critical(lp_sweep_checkpoint)
+      {
+        sweep_block_state& st = ckpt.blocks[b];
+        st.started = true;
+        st.done = done;
+        st.next = next;
+        st.reverse = reverse;
+        st.bmin.assign(bmin, bmin + n_G);
+        st.bmax.assign(bmax, bmax + n_G);
+        st.bidx.assign(bidx, bidx + n_G);
+        st.bfeasible.assign(bfeasible, bfeasible + n_G);
+        st.bsolved.assign(bsolved, bsolved + n_G);
+        st.have_best = have_best;
+        st.best = best;
+        if (std::chrono::steady_clock::now() - ckpt.last_write >= interval) {
+          save_checkpoint(dist, ckpt);
+        }
+      }
+      last_publish = std::chrono::steady_clock::now();
+    };
+    if (first >= last) {
+      continue;
+    }
+    try {
+      LP_sweep sweep(dist, Gs[order[0]], mesh, q, iprime, eps2_sets[level[order[0]]], eps3s, xhats, side);
+      for (int64_t t=first; t<last; ++t) {
+        if (checkpointing && t > first && std::chrono::steady_clock::now() - last_publish >= interval) {
+          publish(t, false);
+        }
+        int64_t idx = idx_list[side][t];
+        std::vector<int64_t> seq(G_of_idx[side][idx]);
+        for (size_t a=0; a<seq.size(); ) { // the direction of G flips with every level and every idx
+          size_t b = a;
+          while (b < seq.size() && level[seq[b]] == level[seq[a]]) {
+            ++b;
+          }
+          if (reverse) {
+            std::reverse(seq.begin() + a, seq.begin() + b);
+          }
+          reverse = !reverse;
+          a = b;
+        }
+        for (auto g:seq) {
+          int64_t G = Gs[g];
+          int64_t p = looser_job[g];
+          if (p >= 0 && stamp[p] == idx && (bound_at[p] == -2 || (bound_at[p] > 0 && have_best[g] && (side ? bound_at[p] <= best[g] : bound_at[p] >= best[g])))) {
+            stamp[g] = idx; // still a bound for the next tighter level
+            bound_at[g] = bound_at[p];
+            continue;
+          }
+          if (!side && have_best[g] && idx <= l && G * mesh[idx-1] >= best[g]) {
+            continue;
+          }
+          sweep.set_G(G);
+          sweep.set_eps2(eps2_sets[level[g]]);
+          double lp_bound = sweep.solve(idx, have_best[g] ? best[g] : inf);
+          stamp[g] = idx;
+          bound_at[g] = lp_bound;
+          ++solved;
+          ++bsolved[g];
+          infeasible += (lp_bound == -2);
+          cutoff_pruned += (lp_bound == -5);
+          if (lp_bound > 0) {
+            if (!bfeasible[g] || (side ? lp_bound > bmax[g] : lp_bound < bmin[g])) {
+              bidx[g] = idx;
+            }
+            bfeasible[g] = true;
+            bmin[g] = std::min(bmin[g], lp_bound);
+            bmax[g] = std::max(bmax[g], lp_bound);
+            best[g] = have_best[g] ? (side ? std::max(best[g], lp_bound) : std::min(best[g], lp_bound)) : lp_bound;
+            have_best[g] = true;
+          }
+        }
+      }
+      if (checkpointing) {
+        publish(last, true);
+      }
+    } catch(const lp_error& e) {
+      #pragma omp atomic write
+      failed = true;
+      if (dist.verbose) {
+        #pragma omp critical
+        std::cerr << "\n[Error: code = " << e.code << "; message: " << e.what() << ".]" << std::endl;
+      }
+    }
+  }
+
+  for (int64_t b=0; b<n_blocks; ++b) {
+    for (int64_t g=0; g<n_G; ++g) {
+      bool better = upper[g] ? block_max[b * n_G + g] > res_max[g] : block_min[b * n_G + g] < res_min[g];
+      if (block_feasible[b * n_G + g] && (!any_feasible[g] || better)) {
+        best_idx[g] = block_idx[b * n_G + g];
+      }
+      res_min[g] = std::min(res_min[g], block_min[b * n_G + g]);
+      res_max[g] = std::max(res_max[g], block_max[b * n_G + g]);
+      any_feasible[g] = any_feasible[g] || block_feasible[b * n_G + g];
+      idx_solved[g] += block_solved[b * n_G + g];
+    }
+  }
+
+  stat_sweeps += n_G;
+  stat_idx_total += n_G * (l + 1);
+  stat_solved += solved;
+  stat_infeasible += infeasible;
+  for (int64_t g=0; g<n_G; ++g) {
+    stat_range_pruned += l + 1 - idx_solved[g];
+  }
+  stat_cutoff_pruned += cutoff_pruned;
+
+  if (checkpointing) {
+    if (failed) {
+      save_checkpoint(dist, ckpt);
+    }
+    else {
+      remove_checkpoint(dist, ckpt);
+    }
+  }
+  if (failed) {
+    return false;
+  }
+  res.resize(n_G);
+  feasible.resize(n_G);
+  for (int64_t g=0; g<n_G; ++g) {
+    res[g] = upper[g] ? res_max[g] : res_min[g];
+    feasible[g] = any_feasible[g];
+  }
+  return true;
+}
+
+// 只有一个err时
+static bool LP_sweep_curve(dist_t& dist, std::vector<int64_t>& Gs, std::vector<double>& mesh, double q, int64_t iprime, std::vector<double>& eps2s, std::vector<double>& eps3s, std::vector<double>& xhats, std::vector<char>& upper, std::vector<double>& res, std::vector<bool>& feasible, std::vector<int64_t>& best_idx) {
+  std::vector<int64_t> level(Gs.size(), 0);
+  std::vector<std::vector<double>> eps2_sets = {eps2s};
+  return LP_sweep_curve(dist, Gs, level, mesh, q, iprime, eps2_sets, eps3s, xhats, upper, res, feasible, best_idx);
+}
+
+lp_sweep_stats get_lp_sweep_stats() {
+  lp_sweep_stats stats;
+  stats.sweeps = stat_sweeps.load();
+  stats.idx_total = stat_idx_total.load();
+  stats.solved = stat_solved.load();
+  stats.infeasible = stat_infeasible.load();
+  stats.range_pruned = stat_range_pruned.load();
+  stats.cutoff_pruned = stat_cutoff_pruned.load();
+  stats.columns = stat_columns.load();
+  stats.aggregated = stat_aggregated.load();
+  stats.iterations = stat_iterations.load();
+  return stats;
+}
+
+void reset_lp_sweep_stats() {
+  stat_sweeps = 0;
+  stat_idx_total = 0;
+  stat_solved = 0;
+  stat_infeasible = 0;
+  stat_range_pruned = 0;
+  stat_cutoff_pruned = 0;
+  stat_columns = 0;
+  stat_aggregated = 0;
+  stat_iterations = 0;
+}
+
+void print_lp_sweep_stats() {
+  lp_sweep_stats stats = get_lp_sweep_stats();
+  std::cout << "[Info] LP sweeps: " << stats.sweeps << "; idx: " << stats.idx_total << "; LPs solved: " << stats.solved
+            << " (infeasible: " << stats.infeasible << "; stopped by cutoff: " << stats.cutoff_pruned << "); idx skipped: " << stats.range_pruned
+            << "; mesh columns: " << stats.columns << " (aggregated away: " << stats.aggregated << "); simplex iterations: " << stats.iterations << std::endl;
+}
+
+// 式中的eps2, eps3（每个i一个）
+static void LP_eps(dist_t& dist, double q, int64_t iprime, std::vector<double>& errs, std::vector<double>& xhats, std::vector<double>& eps2s, std::vector<double>& eps3s) {
+  int64_t N = dist.N;
+  eps2s.resize(iprime+1);
+  eps3s.resize(iprime+1);
+  for (int i=0; i<=iprime; ++i) {
+    eps2s[i] = sqrt(-N * log(errs[i]) / 2.0) * ((((double) i) + 1.0) / ((double) (N - i)));
+    eps3s[i] = exp(log1p_eps3(N, i, q, xhats[i])) - 1;
+  }
+}
+
+// 不可行的G记为-2（只提示一次），其余截到[0, 1]
+static void LP_curve_result(dist_t& dist, std::vector<double>& res, std::vector<bool>& feasible, bool upper) {
+  bool warned = false;
+  for (int64_t g=0; g<(int64_t) res.size(); ++g) {
+    if (!feasible[g]) {
+      if (dist.verbose && !warned) {
+        std::cerr << "\n[Model is infeasible! Sample might not be drawn iid from the underlying distribution.]" << std::endl;
+        warned = true;
+      }
+      res[g] = -2;
+    }
+    else {
+      res[g] = upper ? std::min(res[g], 1.0) : std::max(res[g], 0.0);
+    }
+  }
+}
+
+/*
+整条曲线：对Gs中每个G的LP_LB/LP_UB，结果与逐个调用相同（-2不可行，-3求解器出错），参数不合法时返回空数组
+  所有G共用一次扫描，见LP_sweep_curve
+  want_lb和want_ub都为true时（LP_bounds）两边共用参数检查、eps、网格和bpdf系数，两个扫描在同一个并行区域里进行
+  errs_sets中每组errs（每个err一组）对应lb[e]、ub[e]：eps3s、网格和bpdf系数与err无关，各组共用，
+  eps2s不同的各组在同一次扫描里求解，同一个模型在组之间只改约束(2)的右端项，从上一组的最优基热启动
+  best_x按扫描的顺序（每组errs内LB的G在前、UB的G在后）给出各自最优的idx对应的概率x_{idx-1}（idx = l+1为0，-1表示没有），
+  与网格无关；传入时非空则作为先探测的idx，换一个q的网格也能用（LP_bounds_progressive）
+*/
+static void LP_curve_levels(dist_t& dist, std::vector<int64_t>& Gs, double q, int64_t iprime, std::vector<std::vector<double>>& errs_sets, std::vector<double>& xhats, bool want_lb, bool want_ub, std::vector<std::vector<double>>& lb, std::vector<std::vector<double>>& ub, std::vector<double>& best_x) {
+  prof_span span("LP bounds", "Gs", (double) Gs.size());
+  lb.clear();
+  ub.clear();
+  // Note: error rate will be 2 * sum(errs)
+  for (auto& errs:errs_sets) {
+    for (auto G:Gs) {
+      if (!error_check_LP(dist, G, q, iprime, errs, xhats)) {
+        return;
+      }
+    }
+  }
+
+  int64_t n_levels = errs_sets.size();
+  std::vector<std::vector<double>> eps2_sets(n_levels);
+  std::vector<double> eps3s;
+  for (int64_t e=0; e<n_levels; ++e) {
+    LP_eps(dist, q, iprime, errs_sets[e], xhats, eps2_sets[e], eps3s);
+  }
+  std::vector<double> mesh = make_mesh(dist.N, q);
+
+  // 每组errs内LB的G在前、UB的G在后
+  int64_t n_G = Gs.size();
+  std::vector<int64_t> jobs, level;
+  std::vector<char> upper;
+  for (int64_t e=0; e<n_levels; ++e) {
+    for (int side=0; side<2; ++side) {
+      if (side ? want_ub : want_lb) {
+        jobs.insert(jobs.end(), Gs.begin(), Gs.end());
+        level.insert(level.end(), n_G, e);
+        upper.insert(upper.end(), n_G, side);
+      }
+    }
+  }
+
+  // 缓存里已有的界不再求解，只扫描其余的job
+  int64_t n_jobs = jobs.size();
+  std::vector<std::string> keys(n_jobs);
+  std::vector<double> res(n_jobs);
+  std::vector<bool> feasible(n_jobs);
+  std::vector<int64_t> miss;
+  for (int64_t k=0; k<n_jobs; ++k) {
+    double value;
+    if (bound_cache_enabled(dist)) {
+      keys[k] = bound_cache_key(dist, (upper[k] ? "LP UB" : "LP LB") + LP_solve_mode(dist), jobs[k], q, iprime, errs_sets[level[k]], xhats);
+    }
+    if (bound_cache_enabled(dist) && bound_cache_lookup(dist, keys[k], value)) {
+      res[k] = value;
+      feasible[k] = (value != -2);
+    }
+    else {
+      miss.push_back(k);
+    }
+  }
+
+  int64_t l = mesh.size();
+  std::vector<int64_t> miss_jobs, miss_level, best_idx;
+  std::vector<char> miss_upper;
+  for (auto k:miss) {
+    miss_jobs.push_back(jobs[k]);
+    miss_level.push_back(level[k]);
+    miss_upper.push_back(upper[k]);
+    if (k < (int64_t) best_x.size()) {
+      double x = best_x[k];
+      int64_t i = std::lower_bound(mesh.begin(), mesh.end(), x, std::greater<double>()) - mesh.begin(); // first x_i <= x
+      best_idx.push_back((x < 0) ? 0 : (x == 0) ? l+1 : std::min(i+1, l));
+    }
+  }
+  if (best_idx.size() < miss.size()) {
+    best_idx.clear();
+  }
+
+  std::vector<double> miss_res;
+  std::vector<bool> miss_feasible;
+  bool ok = miss.empty() || LP_sweep_curve(dist, miss_jobs, miss_level, mesh, q, iprime, eps2_sets, eps3s, xhats, miss_upper, miss_res, miss_feasible, best_idx);
+  best_x.assign(n_jobs, -1.0);
+  for (int64_t m=0; m<(int64_t) miss.size(); ++m) {
+    if (ok) {
+      res[miss[m]] = miss_res[m];
+      feasible[miss[m]] = miss_feasible[m];
+    }
+    if (m < (int64_t) best_idx.size()) {
+      int64_t idx = best_idx[m];
+      best_x[miss[m]] = (idx == 0) ? -1.0 : (idx <= l) ? mesh[idx-1] : 0.0;
+    }
+  }
+  lb.resize(n_levels);
+  ub.resize(n_levels);
+  int64_t offset = 0;
+  for (int64_t e=0; e<n_levels; ++e) {
+    for (int side=0; side<2; ++side) {
+      if (!(side ? want_ub : want_lb)) {
+        continue;
+      }
+      std::vector<double>& out = side ? ub[e] : lb[e];
+      if (!ok) {
+        out.assign(n_G, -3);
+        continue;
+      }
+      out.assign(res.begin() + offset, res.begin() + offset + n_G);
+      std::vector<bool> out_feasible(feasible.begin() + offset, feasible.begin() + offset + n_G);
+      LP_curve_result(dist, out, out_feasible, side);
+      std::copy(out.begin(), out.end(), res.begin() + offset);
+      offset += n_G;
+    }
+  }
+  if (ok) {
+    for (auto k:miss) {
+      bound_cache_store(dist, keys[k], res[k]);
+    }
+  }
+}
+
+static void LP_curve_both(dist_t& dist, std::vector<int64_t>& Gs, double q, int64_t iprime, std::vector<double>& errs, std::vector<double>& xhats, bool want_lb, bool want_ub, std::vector<double>& lb, std::vector<double>& ub, std::vector<double>& best_x) {
+  std::vector<std::vector<double>> errs_sets = {errs}, lbs, ubs;
+  LP_curve_levels(dist, Gs, q, iprime, errs_sets, xhats, want_lb, want_ub, lbs, ubs, best_x);
+  lb = lbs.empty() ? std::vector<double>() : lbs[0];
+  ub = ubs.empty() ? std::vector<double>() : ubs[0];
+}
+
+static std::vector<double> LP_curve(dist_t& dist, std::vector<int64_t>& Gs, double q, int64_t iprime, std::vector<double>& errs, std::vector<double>& xhats, bool upper) {
+  std::vector<double> lb, ub, best_x;
+  LP_curve_both(dist, Gs, q, iprime, errs, xhats, !upper, upper, lb, ub, best_x);
+  return upper ? ub : lb;
+}
+
+/*
+阈值形式：不按idx扫描，把idx的选择换成攻击者的概率阈值mu
+  固定分布h时，G次猜测的成功率是背包LP max{sum z_j : 0 <= z_j <= h_j, sum z_j/x_j <= G}，
+  它的对偶是 min_{mu >= 0} G*mu + sum_j h_j (1 - mu/x_j)^+，mu就是最后一个被猜的网格点的概率
+  LB = min_h min_mu (...) = min_mu G*mu + V(mu)，V(mu) = min_{h满足(2)(3)} sum_j h_j (1 - mu/x_j)^+，
+    固定h时最优的mu在某个x_k或0上，所以只需要mu取网格点；V随mu递减，区间(a, b)内的mu（x_a > mu > x_b）
+    不低于 G*x_b + V(x_a)，据此分支定界，先在LP_THRESHOLD_GRID个等距的网格点上求值，再只细分下界低于当前最优值的区间；
+    V与G无关，Gs共用求过的值
+  UB = max_h min_mu (...)：目标对h线性、对mu凸，由极小极大定理等于 min_mu G*mu + U(mu)（U与V同形，取max），
+    g(mu) = G*mu + U(mu) 是mu的凸函数，最优解h的 G - sum_{x_j > mu} h_j/x_j 是它的次梯度，
+    先在网格点上按次梯度的符号二分，再在最后的网格区间内用两端的支撑线求交点（Kelley），
+    支撑线交点的下界与最优值相差不超过LP_THRESHOLD_TOL时停止；任何mu上的g(mu)都是合法的上界
+    UB的idx = l+1时c不受约束(4)限制，相当于一列概率为x_{l-1}、质量至多为1的列，对偶中多一项 (1 - mu/x_{l-1})^+
+  两者都与idx扫描的结果相同（在LP的容差内），但每个G只解几十个只有约束(2)(3)的LP
+*/
+static const int64_t LP_THRESHOLD_GRID = 64;
+static const int64_t LP_THRESHOLD_STEPS = 64; // Kelley steps of the UB inside the last mesh interval
+static const double LP_THRESHOLD_TOL = 1e-12;
+
+static bool LP_threshold_curve(dist_t& dist, std::vector<int64_t>& Gs, std::vector<double>& mesh, double q, int64_t iprime, std::vector<double>& eps2s, std::vector<double>& eps3s, std::vector<double>& xhats, bool upper, std::vector<double>& res, std::vector<bool>& feasible,
+                               std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(), std::vector<double>* limit = nullptr) {
+  prof_span span("LP threshold", "Gs", (double) Gs.size());
+  const double inf = std::numeric_limits<double>::infinity();
+  int64_t l = mesh.size();
+  int64_t n_G = Gs.size();
+  res.assign(n_G, upper ? 1.0 : 0.0);
+  feasible.assign(n_G, true);
+  if (limit) {
+    limit->assign(n_G, upper ? 0.0 : 1.0);
+  }
+
+  LP_sweep model(dist, Gs[0], mesh, q, iprime, eps2s, eps3s, xhats, upper, true);
+  auto mu_of = [&](int64_t k) { return (k < l) ? mesh[k] : 0.0; }; // k == l is mu = 0
+  int64_t solved = 0, evaluated = 0;
+  bool infeasible = false, failed = false;
+  stat_columns += l;
+  stat_aggregated += model.aggregated();
+
+  // the Gs left share what is left of the time, G by G
+  bool timed = deadline != std::chrono::steady_clock::time_point::max();
+  std::chrono::steady_clock::time_point G_deadline = deadline;
+  auto start_G = [&](int64_t g) {
+    if (timed) {
+      auto now = std::chrono::steady_clock::now();
+      G_deadline = now + (std::max(deadline, now) - now) / (n_G - g);
+    }
+  };
+  auto expired = [&]() { return timed && std::chrono::steady_clock::now() >= G_deadline; };
+
+  if (!upper) {
+    std::map<int64_t, double> V;
+    auto value = [&](int64_t k) {
+      ++evaluated;
+      if (V.count(k) == 0) {
+        ++solved;
+        V[k] = model.solve_threshold(mu_of(k));
+      }
+      return V[k];
+    };
+    // min over the evaluated points and, between neighbouring points a < b, the bound G*x_b + V(x_a) of the mu in between;
+    // V >= 0 covers the mu before the first and after the last point
+    auto certified = [&](double G) {
+      double lower = inf;
+      int64_t prev = -1;
+      for (auto& [k, v]:V) {
+        lower = std::min(lower, (prev < 0) ? ((k > 0) ? G * mu_of(k) : inf) : (k - prev > 1) ? G * mu_of(k) + V[prev] : inf);
+        lower = std::min(lower, G * mu_of(k) + v);
+        prev = k;
+      }
+      return (prev < 0) ? 0.0 : (prev < l) ? std::min(lower, V[prev]) : lower;
+    };
+    for (int64_t g=0; g<n_G && !infeasible && !failed; ++g) {
+      start_G(g);
+      double G = Gs[g];
+      double best = inf;
+      bool stopped = false;
+      std::vector<int64_t> grid;
+      for (int64_t t=0; t<=LP_THRESHOLD_GRID; ++t) {
+        int64_t k = t * l / LP_THRESHOLD_GRID;
+        if (grid.empty() || k != grid.back()) {
+          grid.push_back(k);
+        }
+      }
+      // the grid coarse to fine, so a deadline leaves it evenly covered
+      std::vector<char> done(grid.size(), false);
+      for (int64_t step=LP_THRESHOLD_GRID; step>=1 && !stopped && !infeasible && !failed; step/=2) {
+        for (int64_t t=0; t<(int64_t) grid.size(); t+=step) {
+          if (done[t]) {
+            continue;
+          }
+          if (V.count(grid[t]) == 0 && expired()) {
+            stopped = true;
+            break;
+          }
+          done[t] = true;
+          double v = value(grid[t]);
+          if (v < 0) {
+            infeasible = (v == -2);
+            failed = !infeasible;
+            break;
+          }
+          best = std::min(best, G * mu_of(grid[t]) + v);
+        }
+      }
+      // intervals with the smallest bound first, the refinement stops when none is below the best value
+      std::priority_queue<std::tuple<double, int64_t, int64_t>, std::vector<std::tuple<double, int64_t, int64_t>>, std::greater<>> todo;
+      auto push = [&](int64_t a, int64_t b) {
+        if (b - a > 1) {
+          todo.push({G * mu_of(b) + V[a], a, b});
+        }
+      };
+      for (size_t t=1; t<grid.size() && !stopped; ++t) {
+        push(grid[t-1], grid[t]);
+      }
+      while (!todo.empty() && !stopped && !infeasible && !failed) {
+        auto [lower, a, b] = todo.top();
+        if (lower >= best) {
+          break;
+        }
+        int64_t m = (a + b) / 2;
+        if (V.count(m) == 0 && expired()) {
+          stopped = true;
+          break;
+        }
+        todo.pop();
+        double v = value(m);
+        if (v < 0) {
+          infeasible = (v == -2);
+          failed = !infeasible;
+          break;
+        }
+        best = std::min(best, G * mu_of(m) + v);
+        push(a, m);
+        push(m, b);
+      }
+      res[g] = stopped ? certified(G) : best;
+      if (limit) {
+        (*limit)[g] = std::min(best, 1.0);
+      }
+    }
+  }
+  else {
+    std::vector<double> hx, rc;
+    // g(mu)和它在mu处的右次梯度
+    auto value = [&](double G, double mu, double& slope) {
+      ++solved;
+      ++evaluated;
+      double v = model.solve_threshold(mu);
+      if (v < 0) {
+        infeasible = (v == -2);
+        failed = !infeasible;
+        return inf;
+      }
+      model.solution(hx, rc);
+      slope = G;
+      for (int64_t j=0; j<l && mesh[j] > mu; ++j) {
+        slope -= hx[j] / mesh[j];
+      }
+      if (mu < mesh[l-1]) {
+        v += 1.0 - mu / mesh[l-1];
+        slope -= 1.0 / mesh[l-1];
+      }
+      return G * mu + v;
+    };
+    for (int64_t g=0; g<n_G && !infeasible && !failed; ++g) {
+      start_G(g);
+      double G = Gs[g];
+      // mu = x_a的次梯度为正，mu = x_b的不为正，最优的mu在[x_b, x_a]内
+      int64_t a = 0, b = l;
+      double s_a = 0, s_b = 0, g_a = inf, g_b = inf;
+      double best = inf;
+      // the support lines at the two ends of the bracket meet below the minimum
+      auto kelley = [&](double mu_a, double mu_b) {
+        if (!(s_a > s_b) || g_a == inf || g_b == inf) {
+          return 0.0;
+        }
+        double mu_c = (g_b - g_a + s_a * mu_a - s_b * mu_b) / (s_a - s_b);
+        return g_a + s_a * (mu_c - mu_a);
+      };
+      if (expired()) {
+        continue;
+      }
+      g_a = value(G, mu_of(a), s_a);
+      best = std::min(best, g_a);
+      if (!expired() && !infeasible && !failed) {
+        g_b = value(G, mu_of(b), s_b);
+        best = std::min(best, g_b);
+      }
+      bool stopped = (g_b == inf);
+      if (s_a <= 0) { // only when G*x_0 is tiny
+        b = a;
+        g_b = g_a;
+        s_b = s_a;
+      }
+      while (b - a > 1 && !stopped && !infeasible && !failed) {
+        if (expired()) {
+          stopped = true;
+          break;
+        }
+        int64_t m = (a + b) / 2;
+        double s_m = 0;
+        double g_m = value(G, mu_of(m), s_m);
+        if (infeasible || failed) {
+          break;
+        }
+        best = std::min(best, g_m);
+        if (s_m > 0) {
+          a = m;
+          g_a = g_m;
+          s_a = s_m;
+        }
+        else {
+          b = m;
+          g_b = g_m;
+          s_b = s_m;
+        }
+      }
+      double mu_a = mu_of(a), mu_b = mu_of(b);
+      for (int64_t t=0; t<LP_THRESHOLD_STEPS && a != b && s_a > s_b && !stopped && !infeasible && !failed; ++t) {
+        double mu_c = (g_b - g_a + s_a * mu_a - s_b * mu_b) / (s_a - s_b);
+        double lower = g_a + s_a * (mu_c - mu_a);
+        if (best - lower <= LP_THRESHOLD_TOL * (1.0 + fabs(best)) || !(mu_c > mu_b && mu_c < mu_a)) {
+          break;
+        }
+        if (expired()) {
+          stopped = true;
+          break;
+        }
+        double s_c = 0;
+        double g_c = value(G, mu_c, s_c);
+        if (infeasible || failed) {
+          break;
+        }
+        best = std::min(best, g_c);
+        if (s_c > 0) {
+          mu_a = mu_c;
+          g_a = g_c;
+          s_a = s_c;
+        }
+        else {
+          mu_b = mu_c;
+          g_b = g_c;
+          s_b = s_c;
+        }
+      }
+      res[g] = best;
+      if (limit) {
+        (*limit)[g] = stopped ? std::max(kelley(mu_a, mu_b), 0.0) : best;
+      }
+    }
+  }
+
+  stat_sweeps += n_G;
+  stat_idx_total += n_G * (l + 1);
+  stat_solved += solved;
+  stat_range_pruned += std::max<int64_t>(n_G * (l + 1) - evaluated, 0);
+  if (infeasible) {
+    stat_infeasible += 1;
+    feasible.assign(n_G, false);
+  }
+  return !failed;
+}
+
+static std::vector<double> LP_threshold(dist_t& dist, std::vector<int64_t>& Gs, double q, int64_t iprime, std::vector<double>& errs, std::vector<double>& xhats, bool upper) {
+  if (Gs.empty()) {
+    return std::vector<double>();
+  }
+  for (auto G:Gs) {
+    if (!error_check_LP(dist, G, q, iprime, errs, xhats)) {
+      return std::vector<double>();
+    }
+  }
+
+  // 缓存里已有的G不再求解
+  std::vector<std::string> keys(Gs.size());
+  std::vector<double> res(Gs.size());
+  std::vector<int64_t> miss, miss_Gs;
+  for (int64_t g=0; g<(int64_t) Gs.size(); ++g) {
+    if (bound_cache_enabled(dist)) {
+      keys[g] = bound_cache_key(dist, (upper ? "LP UB threshold" : "LP LB threshold") + LP_solve_mode(dist), Gs[g], q, iprime, errs, xhats);
+    }
+    if (!bound_cache_enabled(dist) || !bound_cache_lookup(dist, keys[g], res[g])) {
+      miss.push_back(g);
+      miss_Gs.push_back(Gs[g]);
+    }
+  }
+  if (miss.empty()) {
+    return res;
+  }
+
+  std::vector<double> eps2s, eps3s;
+  LP_eps(dist, q, iprime, errs, xhats, eps2s, eps3s);
+  std::vector<double> mesh = make_mesh(dist.N, q);
+
+  std::vector<double> miss_res;
+  std::vector<bool> feasible;
+  try {
+    if (!LP_threshold_curve(dist, miss_Gs, mesh, q, iprime, eps2s, eps3s, xhats, upper, miss_res, feasible)) {
+      return std::vector<double>(Gs.size(), -3);
+    }
+  } catch(const lp_error& e) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: code = " << e.code << "; message: " << e.what() << ".]" << std::endl;
+    }
+    return std::vector<double>(Gs.size(), -3);
+  }
+  LP_curve_result(dist, miss_res, feasible, upper);
+  for (int64_t m=0; m<(int64_t) miss.size(); ++m) {
+    res[miss[m]] = miss_res[m];
+    bound_cache_store(dist, keys[miss[m]], miss_res[m]);
+  }
+  return res;
+}
+
+/*
+自适应网格：先在粗网格（比为q_coarse）上求解，只把最优解附近的区间加密到q_fine
+  eps3s按q_fine计算，粗的列按各自的桶比计算（见LP_sweep），任何网格上的扫描结果都是合法的界
+  每轮先完整扫描一次idx得到界和最优的idx，再只在各G最优的idx上迭代加密：
+    比值超过q_fine的区间，如果距离支撑点（h_j > 0）不超过W个区间、或者旁边的列对偶活跃（|检验数|很小，
+    加密后容易进基），就按几何比细分成比值不超过q_fine的若干段，所有G的加密合在一个网格上；
+    粗的列比细分后的列松，最优解总会挪到加密区域边上的粗列里，W每次加倍，几次就能盖住整个支撑；
+  最优解只用到细的列时停止加密，下一轮扫描；某一轮扫描后最优解已经只用细的列时结束，
+  这时的界与全部加密到q_fine（slow）的一致。LB取各轮的最大值、UB取最小值
+*/
+static const int64_t LP_ADAPTIVE_ROUNDS = 4; // full idx sweeps
+static const int64_t LP_ADAPTIVE_STEPS = 16; // refinement steps at the best idx per round
+static const double LP_SUPPORT_TOL = 1e-12; // h_j above this is a support point
+static const double LP_DUAL_ACTIVE_TOL = 1e-2; // |reduced cost| below this is dual-active
+
+/*
+在每个G最优的idx上求解，标出要细分的区间并细分mesh，best_idx换成新网格上的位置
+  W为支撑点两侧要细分的区间数，返回false表示没有要细分的区间，lp_error直接抛出
+*/
+static bool LP_refine_mesh(dist_t& dist, std::vector<int64_t>& Gs, std::vector<double>& mesh, double q_fine, int64_t iprime, std::vector<double>& eps2s, std::vector<double>& eps3s, std::vector<double>& xhats, bool upper, std::vector<int64_t>& best_idx, int64_t W) {
+  int64_t n_G = Gs.size();
+  int64_t l = mesh.size();
+  std::vector<char> coarse(l-1); // interval [mesh[a+1], mesh[a]] is wider than q_fine
+  for (int64_t a=0; a<l-1; ++a) {
+    coarse[a] = mesh[a] / mesh[a+1] > q_fine * (1.0 + 1e-9);
+  }
+
+  std::vector<std::vector<char>> marked(n_G);
+  bool failed = false;
+  thread_split split = split_threads(dist, n_G, "mesh refinement");
+  #pragma omp parallel for schedule(dynamic, 1) num_threads(split.outer)
+  for (int64_t g=0; g<n_G; ++g) {
+    thread_job job(split);
+    prof_span span("mesh refinement", "G", (double) Gs[g]);
+    if (best_idx[g] == 0) {
+      continue;
+    }
+    try {
+      LP_sweep sweep(dist, Gs[g], mesh, q_fine, iprime, eps2s, eps3s, xhats, upper);
+      if (sweep.solve(best_idx[g]) <= 0) {
+        continue;
+      }
+      std::vector<double> hx, rc;
+      sweep.solution(hx, rc);
+      marked[g].assign(l-1, false);
+      for (int64_t j=0; j<l; ++j) {
+        bool support = hx[j] > LP_SUPPORT_TOL;
+        bool active = fabs(rc[j]) < LP_DUAL_ACTIVE_TOL;
+        int64_t first = support ? std::max<int64_t>(j-1-W, 0) : std::max<int64_t>(j-1, 0);
+        int64_t last = support ? std::min(j+W, l-2) : std::min(j, l-2);
+        if (!support && !active) {
+          continue;
+        }
+        for (int64_t a=first; a<=last; ++a) {
+          marked[g][a] = marked[g][a] || coarse[a];
+        }
+      }
+    } catch(const lp_error& e) {
+      #pragma omp atomic write
+      failed = true;
+      if (dist.verbose) {
+        #pragma omp critical
+        std::cerr << "\n[Error: code = " << e.code << "; message: " << e.what() << ".]" << std::endl;
+      }
+    }
+  }
+  if (failed) {
+    throw lp_error(-3, "refinement failed");
+  }
+
+  std::vector<double> refined;
+  std::vector<int64_t> pos(l); // position of mesh[j] in refined
+  bool changed = false;
+  for (int64_t a=0; a<l; ++a) {
+    pos[a] = refined.size();
+    refined.push_back(mesh[a]);
+    bool mark = false;
+    for (int64_t g=0; g<n_G && a<l-1; ++g) {
+      mark = mark || (!marked[g].empty() && marked[g][a]);
+    }
+    if (mark) {
+      double r = mesh[a] / mesh[a+1];
+      int64_t parts = (int64_t) ceil(log(r) / log(q_fine) - 1e-9);
+      for (int64_t t=1; t<parts; ++t) {
+        refined.push_back(mesh[a] * pow(r, -((double) t) / parts));
+      }
+      changed = true;
+    }
+  }
+  for (auto& idx:best_idx) {
+    if (idx >= 1) {
+      idx = (idx <= l) ? pos[idx-1] + 1 : (int64_t) refined.size() + 1;
+    }
+  }
+  mesh.swap(refined);
+  return changed;
+}
+
+static std::vector<double> LP_curve_adaptive(dist_t& dist, std::vector<int64_t>& Gs, double q_coarse, double q_fine, int64_t iprime, std::vector<double>& errs, std::vector<double>& xhats, bool upper) {
+  for (auto G:Gs) {
+    if (!error_check_LP(dist, G, q_fine, iprime, errs, xhats)) {
+      return std::vector<double>();
+    }
+  }
+  if (q_coarse < q_fine) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: q_coarse must not be smaller than q_fine.]" << std::endl;
+    }
+    return std::vector<double>();
+  }
+
+  int64_t n_G = Gs.size();
+  std::vector<double> eps2s, eps3s;
+  LP_eps(dist, q_fine, iprime, errs, xhats, eps2s, eps3s);
+  std::vector<double> mesh = make_mesh(dist.N, q_coarse);
+
+  std::vector<double> best(n_G, upper ? 1.0 : 0.0);
+  std::vector<bool> feasible(n_G, true);
+  int64_t W = 1;
+  std::vector<int64_t> best_idx; // carried to the next sweep as its first probe
+  for (int64_t round=0; round<LP_ADAPTIVE_ROUNDS; ++round) {
+    std::vector<double> res;
+    std::vector<bool> round_feasible;
+    std::vector<char> sides(n_G, upper);
+    if (!LP_sweep_curve(dist, Gs, mesh, q_fine, iprime, eps2s, eps3s, xhats, sides, res, round_feasible, best_idx)) {
+      return std::vector<double>(n_G, -3);
+    }
+    for (int64_t g=0; g<n_G; ++g) {
+      feasible[g] = feasible[g] && round_feasible[g];
+      if (feasible[g]) {
+        best[g] = upper ? std::min(best[g], res[g]) : std::max(best[g], res[g]);
+      }
+      else {
+        best_idx[g] = 0;
+      }
+    }
+    if (round == LP_ADAPTIVE_ROUNDS - 1) {
+      break;
+    }
+
+    int64_t steps = 0;
+    try {
+      while (steps < LP_ADAPTIVE_STEPS && LP_refine_mesh(dist, Gs, mesh, q_fine, iprime, eps2s, eps3s, xhats, upper, best_idx, W)) {
+        ++steps;
+        W *= 2;
+      }
+    } catch(const lp_error& e) {
+      return std::vector<double>(n_G, -3);
+    }
+    if (steps == 0) {
+      break; // the optimal solutions only use fine columns
+    }
+  }
+
+  LP_curve_result(dist, best, feasible, upper);
+  return best;
+}
+
+double LP_LB(dist_t& dist, int64_t G, double q, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
+  if (!error_check_LP(dist, G, q, iprime, errs, xhats)) {
+    return -1;
+  }
+  std::vector<int64_t> Gs = {G};
+  return LP_curve(dist, Gs, q, iprime, errs, xhats, false)[0];
+}
+
+double LP_UB(dist_t& dist, int64_t G, double q, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
+  if (!error_check_LP(dist, G, q, iprime, errs, xhats)) {
+    return -1;
+  }
+  std::vector<int64_t> Gs = {G};
+  return LP_curve(dist, Gs, q, iprime, errs, xhats, true)[0];
+}
+
+std::vector<double> LP_LB(dist_t& dist, std::vector<int64_t> Gs, double q, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
+  return LP_curve(dist, Gs, q, iprime, errs, xhats, false);
+}
+
+std::vector<double> LP_UB(dist_t& dist, std::vector<int64_t> Gs, double q, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
+  return LP_curve(dist, Gs, q, iprime, errs, xhats, true);
+}
+
+/*
+三种精度模式的参数
+fast: q=1.008, iprime=6; normal: q=1.004, iprime=6，errs按比例缩放到总和err/2
+slow: q=1.002, iprime=4，errs固定（err=0.01，置信度为99%）
+*/
+static void LP_preset(dist_t& dist, std::string preset, double err, double& q, int64_t& iprime, std::vector<double>& errs, std::vector<double>& xhats) {
+  // xhats were checked against the N of the sample they were loaded for, a smaller sample read since can break xhat * q < 1
+  bool calibrated_fits = std::all_of(dist.lp_xhats.begin(), dist.lp_xhats.end(), [&](double x) { return x * dist.lp_q < dist.N; });
+  if (preset == "calibrated" && dist.lp_q > 1 && calibrated_fits) {
+    // set by LP_calibrate or load_lp_params: xhats in units of 1/N, errs in units of err
+    q = dist.lp_q;
+    iprime = dist.lp_iprime;
+    xhats.clear();
+    errs.clear();
+    for (auto x:dist.lp_xhats) {
+      xhats.push_back(x / dist.N);
+    }
+    for (auto x:dist.lp_errs) {
+      errs.push_back(x * err);
+    }
+    return;
+  }
+  if (preset == "calibrated") {
+    if (dist.verbose) {
+      std::cerr << (calibrated_fits ? "\n[Warning: No calibrated LP parameters, using the slow preset.]"
+                                    : "\n[Warning: Calibrated xhats don't fit this sample's N, using the slow preset.]") << std::endl;
+    }
+    preset = "slow";
+  }
+  if (preset == "slow") {
+    q = 1.002;
+    iprime = 4;
+    xhats = {7.0/dist.N, 11.0/dist.N, 14.0/dist.N, 16.3/dist.N, 18.5/dist.N};
+    errs = {0.00009, 0.000165, 0.00175, 0.00175, 0.0012};
+    // double sum = std::accumulate(errs.begin(), errs.end(), 0.0);
+    // for (auto& x:errs) {
+    //   x *= (err / (2.0 * sum));
+    // }
+    return;
+  }
+  q = (preset == "fast") ? 1.008 : 1.004;
+  iprime = 6;
+  xhats = {3.0/dist.N, 4.0/dist.N, 5.0/dist.N, 6.0/dist.N, 7.0/dist.N, 8.0/dist.N, 9.0/dist.N};
+  errs = {1, 1.5, 1.75, 1.875, 1.9375, 1.96875, 1.984375};
+  double sum = std::accumulate(errs.begin(), errs.end(), 0.0);
+  for (auto& x:errs) {
+    x *= (err / (2.0 * sum));
+  }
+}
+
+static double LP_preset_bound(dist_t& dist, int64_t G, double err, std::string preset, bool upper) {
+  if (!error_check_basic(dist, G, err)) {
+    return -1;
+  }
+  double q;
+  int64_t iprime;
+  std::vector<double> errs, xhats;
+  LP_preset(dist, preset, err, q, iprime, errs, xhats);
+  return upper ? LP_UB(dist, G, q, iprime, errs, xhats) : LP_LB(dist, G, q, iprime, errs, xhats);
+}
+
+static std::vector<double> LP_preset_curve(dist_t& dist, std::vector<int64_t>& Gs, double err, std::string preset, bool upper) {
+  if (!error_check_basic(dist, Gs, err)) {
+    return std::vector<double>();
+  }
+  double q;
+  int64_t iprime;
+  std::vector<double> errs, xhats;
+  LP_preset(dist, preset, err, q, iprime, errs, xhats);
+  return LP_curve(dist, Gs, q, iprime, errs, xhats, upper);
+}
+
+static void LP_preset_both(dist_t& dist, std::vector<int64_t>& Gs, double err, std::string preset, std::vector<double>& lb, std::vector<double>& ub) {
+  lb.clear();
+  ub.clear();
+  if (!error_check_basic(dist, Gs, err)) {
+    return;
+  }
+  double q;
+  int64_t iprime;
+  std::vector<double> errs, xhats;
+  LP_preset(dist, preset, err, q, iprime, errs, xhats);
+  std::vector<double> best_x;
+  LP_curve_both(dist, Gs, q, iprime, errs, xhats, true, true, lb, ub, best_x);
+}
+
+static std::vector<double> LP_preset_threshold(dist_t& dist, std::vector<int64_t>& Gs, double err, std::string preset, bool upper) {
+  if (!error_check_basic(dist, Gs, err)) {
+    return std::vector<double>();
+  }
+  double q;
+  int64_t iprime;
+  std::vector<double> errs, xhats;
+  LP_preset(dist, preset, err, q, iprime, errs, xhats);
+  return LP_threshold(dist, Gs, q, iprime, errs, xhats, upper);
+}
+
+/*
+有时限的阈值形式：LP_threshold_curve在截止时间停下，各G平分剩下的时间
+  LB：分支定界从粗到细地覆盖网格，停下时取求过的点和相邻两点之间区间的下界 G*x_b + V(x_a) 的最小值，
+    它不大于完整的分支定界的结果，是合法的下界；limit为求过的点中的最小值，完整求解的值不超过它
+  UB：任何求过的g(mu)都是合法的上界；limit为括住最优mu的两条支撑线的交点，完整求解的值不低于它
+  区间按下界从小到大细分，合法的下界随时间单调增加
+*/
+static lp_anytime_result LP_anytime(dist_t& dist, std::vector<int64_t>& Gs, double err, double seconds, std::string preset, bool upper) {
+  lp_anytime_result out;
+  if (!error_check_basic(dist, Gs, err) || Gs.empty()) {
+    return out;
+  }
+  if (!(seconds >= 0)) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: Time limit must be non-negative.]" << std::endl;
+    }
+    return out;
+  }
+  double q;
+  int64_t iprime;
+  std::vector<double> errs, xhats;
+  LP_preset(dist, preset, err, q, iprime, errs, xhats);
+  for (auto G:Gs) {
+    if (!error_check_LP(dist, G, q, iprime, errs, xhats)) {
+      return out;
+    }
+  }
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(std::min(seconds, 1e9)));
+  std::vector<double> eps2s, eps3s;
+  LP_eps(dist, q, iprime, errs, xhats, eps2s, eps3s);
+  std::vector<double> mesh = make_mesh(dist.N, q);
+
+  std::vector<bool> feasible;
+  try {
+    if (!LP_threshold_curve(dist, Gs, mesh, q, iprime, eps2s, eps3s, xhats, upper, out.bound, feasible, deadline, &out.limit)) {
+      out.bound.assign(Gs.size(), -3);
+      out.limit.assign(Gs.size(), -3);
+      out.complete.assign(Gs.size(), false);
+      return out;
+    }
+  } catch(const lp_error& e) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: code = " << e.code << "; message: " << e.what() << ".]" << std::endl;
+    }
+    out.bound.assign(Gs.size(), -3);
+    out.limit.assign(Gs.size(), -3);
+    out.complete.assign(Gs.size(), false);
+    return out;
+  }
+  LP_curve_result(dist, out.bound, feasible, upper);
+  bool verbose = dist.verbose;
+  dist.verbose = false; // warned once above
+  LP_curve_result(dist, out.limit, feasible, upper);
+  dist.verbose = verbose;
+  for (size_t g=0; g<Gs.size(); ++g) {
+    out.complete.push_back(out.bound[g] == out.limit[g]);
+  }
+  return out;
+}
+
+static std::vector<double> LP_preset_adaptive(dist_t& dist, std::vector<int64_t>& Gs, double err, bool upper) {
+  if (!error_check_basic(dist, Gs, err)) {
+    return std::vector<double>();
+  }
+  double q_coarse, q_fine;
+  int64_t iprime;
+  std::vector<double> errs, xhats;
+  LP_preset(dist, "fast", err, q_coarse, iprime, errs, xhats);
+  LP_preset(dist, "slow", err, q_fine, iprime, errs, xhats);
+  return LP_curve_adaptive(dist, Gs, q_coarse, q_fine, iprime, errs, xhats, upper);
+}
+
+double LP_LB(dist_t& dist, int64_t G, double err) {
+  return LP_LB_normal(dist, G, err);
+}
+
+double LP_UB(dist_t& dist, int64_t G, double err) {
+  return LP_UB_normal(dist, G, err);
+}
+
+// Fast version with q=1.008,iprime=6
+double LP_LB_fast(dist_t& dist, int64_t G, double err) {
+  return LP_preset_bound(dist, G, err, "fast", false);
+}
+
+double LP_UB_fast(dist_t& dist, int64_t G, double err) {
+  return LP_preset_bound(dist, G, err, "fast", true);
+}
+
+// Normal version with q=1.004, iprime=6
+double LP_LB_normal(dist_t& dist, int64_t G, double err) {
+  return LP_preset_bound(dist, G, err, "normal", false);
+}
+
+double LP_UB_normal(dist_t& dist, int64_t G, double err) {
+  return LP_preset_bound(dist, G, err, "normal", true);
+}
+
+// Slow version with q=1.002,iprime=4,err=0.01置信度为99%
+double LP_LB_slow(dist_t& dist, int64_t G, double err=0.01) {
+  return LP_preset_bound(dist, G, err, "slow", false);
+}
+
+double LP_UB_slow(dist_t& dist, int64_t G, double err=0.01) {
+  return LP_preset_bound(dist, G, err, "slow", true);
+}
+
+// 整条曲线的版本，Gs一起求解
+std::vector<double> LP_LB(dist_t& dist, std::vector<int64_t> Gs, double err) {
+  return LP_LB_normal(dist, Gs, err);
+}
+
+std::vector<double> LP_UB(dist_t& dist, std::vector<int64_t> Gs, double err) {
+  return LP_UB_normal(dist, Gs, err);
+}
+
+std::vector<double> LP_LB_fast(dist_t& dist, std::vector<int64_t> Gs, double err) {
+  return LP_preset_curve(dist, Gs, err, "fast", false);
+}
+
+std::vector<double> LP_UB_fast(dist_t& dist, std::vector<int64_t> Gs, double err) {
+  return LP_preset_curve(dist, Gs, err, "fast", true);
+}
+
+std::vector<double> LP_LB_normal(dist_t& dist, std::vector<int64_t> Gs, double err) {
+  return LP_preset_curve(dist, Gs, err, "normal", false);
+}
+
+std::vector<double> LP_UB_normal(dist_t& dist, std::vector<int64_t> Gs, double err) {
+  return LP_preset_curve(dist, Gs, err, "normal", true);
+}
+
+std::vector<double> LP_LB_slow(dist_t& dist, std::vector<int64_t> Gs, double err) {
+  return LP_preset_curve(dist, Gs, err, "slow", false);
+}
+
+std::vector<double> LP_UB_slow(dist_t& dist, std::vector<int64_t> Gs, double err) {
+  return LP_preset_curve(dist, Gs, err, "slow", true);
+}
+
+// 自适应网格版本：粗网格q=1.008，只在最优解附近加密到slow的q=1.002，其余参数与slow相同
+std::vector<double> LP_LB_adaptive(dist_t& dist, std::vector<int64_t> Gs, double err) {
+  return LP_preset_adaptive(dist, Gs, err, false);
+}
+
+std::vector<double> LP_UB_adaptive(dist_t& dist, std::vector<int64_t> Gs, double err) {
+  return LP_preset_adaptive(dist, Gs, err, true);
+}
+
+double LP_LB_adaptive(dist_t& dist, int64_t G, double err) {
+  if (!error_check_basic(dist, G, err)) {
+    return -1;
+  }
+  return LP_LB_adaptive(dist, std::vector<int64_t>{G}, err)[0];
+}
+
+double LP_UB_adaptive(dist_t& dist, int64_t G, double err) {
+  if (!error_check_basic(dist, G, err)) {
+    return -1;
+  }
+  return LP_UB_adaptive(dist, std::vector<int64_t>{G}, err)[0];
+}
+
+double LP_LB_adaptive(dist_t& dist, int64_t G, double q_coarse, double q_fine, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
+  if (!error_check_LP(dist, G, q_fine, iprime, errs, xhats)) {
+    return -1;
+  }
+  std::vector<int64_t> Gs = {G};
+  std::vector<double> res = LP_curve_adaptive(dist, Gs, q_coarse, q_fine, iprime, errs, xhats, false);
+  return res.empty() ? -1 : res[0];
+}
+
+double LP_UB_adaptive(dist_t& dist, int64_t G, double q_coarse, double q_fine, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
+  if (!error_check_LP(dist, G, q_fine, iprime, errs, xhats)) {
+    return -1;
+  }
+  std::vector<int64_t> Gs = {G};
+  std::vector<double> res = LP_curve_adaptive(dist, Gs, q_coarse, q_fine, iprime, errs, xhats, true);
+  return res.empty() ? -1 : res[0];
+}
+
+// 阈值形式：结果与idx扫描相同，每个G只解几十个LP，见LP_threshold_curve
+double LP_LB_threshold(dist_t& dist, int64_t G, double q, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
+  if (!error_check_LP(dist, G, q, iprime, errs, xhats)) {
+    return -1;
+  }
+  std::vector<int64_t> Gs = {G};
+  return LP_threshold(dist, Gs, q, iprime, errs, xhats, false)[0];
+}
+
+double LP_UB_threshold(dist_t& dist, int64_t G, double q, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
+  if (!error_check_LP(dist, G, q, iprime, errs, xhats)) {
+    return -1;
+  }
+  std::vector<int64_t> Gs = {G};
+  return LP_threshold(dist, Gs, q, iprime, errs, xhats, true)[0];
+}
+
+std::vector<double> LP_LB_threshold(dist_t& dist, std::vector<int64_t> Gs, double q, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
+  return LP_threshold(dist, Gs, q, iprime, errs, xhats, false);
+}
+
+std::vector<double> LP_UB_threshold(dist_t& dist, std::vector<int64_t> Gs, double q, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
+  return LP_threshold(dist, Gs, q, iprime, errs, xhats, true);
+}
+
+double LP_LB_threshold(dist_t& dist, int64_t G, double err, std::string preset) {
+  if (!error_check_basic(dist, G, err)) {
+    return -1;
+  }
+  return LP_LB_threshold(dist, std::vector<int64_t>{G}, err, preset)[0];
+}
+
+double LP_UB_threshold(dist_t& dist, int64_t G, double err, std::string preset) {
+  if (!error_check_basic(dist, G, err)) {
+    return -1;
+  }
+  return LP_UB_threshold(dist, std::vector<int64_t>{G}, err, preset)[0];
+}
+
+std::vector<double> LP_LB_threshold(dist_t& dist, std::vector<int64_t> Gs, double err, std::string preset) {
+  return LP_preset_threshold(dist, Gs, err, preset, false);
+}
+
+std::vector<double> LP_UB_threshold(dist_t& dist, std::vector<int64_t> Gs, double err, std::string preset) {
+  return LP_preset_threshold(dist, Gs, err, preset, true);
+}
+
+lp_anytime_result LP_LB_anytime(dist_t& dist, std::vector<int64_t> Gs, double err, double seconds, std::string preset) {
+  return LP_anytime(dist, Gs, err, seconds, preset, false);
+}
+
+lp_anytime_result LP_UB_anytime(dist_t& dist, std::vector<int64_t> Gs, double err, double seconds, std::string preset) {
+  return LP_anytime(dist, Gs, err, seconds, preset, true);
+}
+
+// LB和UB一起求，两边共用参数检查、eps、网格和bpdf系数，两个扫描并发进行；结果为(LB, UB)
+std::pair<double, double> LP_bounds(dist_t& dist, int64_t G, double q, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
+  if (!error_check_LP(dist, G, q, iprime, errs, xhats)) {
+    return {-1, -1};
+  }
+  std::vector<int64_t> Gs = {G};
+  std::vector<double> lb, ub, best_x;
+  LP_curve_both(dist, Gs, q, iprime, errs, xhats, true, true, lb, ub, best_x);
+  return {lb[0], ub[0]};
+}
+
+std::pair<std::vector<double>, std::vector<double>> LP_bounds(dist_t& dist, std::vector<int64_t> Gs, double q, int64_t iprime, std::vector<double> errs, std::vector<double> xhats) {
+  std::vector<double> lb, ub, best_x;
+  LP_curve_both(dist, Gs, q, iprime, errs, xhats, true, true, lb, ub, best_x);
+  return {lb, ub};
+}
+
+std::pair<double, double> LP_bounds(dist_t& dist, int64_t G, double err, std::string preset) {
+  if (!error_check_basic(dist, G, err)) {
+    return {-1, -1};
+  }
+  std::vector<int64_t> Gs = {G};
+  std::vector<double> lb, ub;
+  LP_preset_both(dist, Gs, err, preset, lb, ub);
+  if (lb.empty()) {
+    return {-1, -1};
+  }
+  return {lb[0], ub[0]};
+}
+
+std::pair<std::vector<double>, std::vector<double>> LP_bounds(dist_t& dist, std::vector<int64_t> Gs, double err, std::string preset) {
+  std::vector<double> lb, ub;
+  LP_preset_both(dist, Gs, err, preset, lb, ub);
+  return {lb, ub};
+}
+
+// 多个err：每个err一组(LB, UB)，网格、bpdf系数和模型在各err之间共用，见LP_curve_levels
+std::vector<std::pair<std::vector<double>, std::vector<double>>> LP_bounds(dist_t& dist, std::vector<int64_t> Gs, std::vector<double> errs, std::string preset) {
+  std::vector<std::pair<std::vector<double>, std::vector<double>>> res;
+  if (errs.empty()) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: errs must not be empty.]" << std::endl;
+    }
+    return res;
+  }
+  for (auto err:errs) {
+    if (!error_check_basic(dist, Gs, err)) {
+      return res;
+    }
+  }
+  double q;
+  int64_t iprime;
+  std::vector<double> xhats, best_x;
+  std::vector<std::vector<double>> errs_sets(errs.size()), lbs, ubs;
+  for (size_t e=0; e<errs.size(); ++e) {
+    LP_preset(dist, preset, errs[e], q, iprime, errs_sets[e], xhats); // only errs depends on err
+  }
+  LP_curve_levels(dist, Gs, q, iprime, errs_sets, xhats, true, true, lbs, ubs, best_x);
+  for (size_t e=0; e<lbs.size(); ++e) {
+    res.push_back({lbs[e], ubs[e]});
+  }
+  return res;
+}
+
+/*
+逐级提高精度：先用fast求所有G的(LB, UB)，UB - LB超过gap的G再用normal、仍超过的再用slow，
+  每一级只求还没达到gap的G，LB和UB一起求（见LP_bounds）；上一级每个G最优的idx换算成概率，作为下一级先探测的idx
+  每个G报告最后求解的那一级的结果（各级的errs、xhats不同，不取各级的最大/最小），preset[g]为这一级的名字；
+  不可行或出错的G不再升级
+*/
+lp_progressive_result LP_bounds_progressive(dist_t& dist, std::vector<int64_t> Gs, double err, double gap) {
+  lp_progressive_result res;
+  if (!error_check_basic(dist, Gs, err)) {
+    return res;
+  }
+  if (!(gap >= 0)) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: gap must be non-negative.]" << std::endl;
+    }
+    return res;
+  }
+
+  int64_t n_G = Gs.size();
+  res.lb.assign(n_G, -1);
+  res.ub.assign(n_G, -1);
+  res.preset.assign(n_G, "");
+  std::vector<double> hint_lb(n_G, -1.0), hint_ub(n_G, -1.0);
+  std::vector<int64_t> todo(n_G);
+  std::iota(todo.begin(), todo.end(), 0);
+  for (std::string preset:{"fast", "normal", "slow"}) {
+    std::vector<int64_t> level_Gs;
+    std::vector<double> best_x;
+    for (auto g:todo) {
+      level_Gs.push_back(Gs[g]);
+      best_x.push_back(hint_lb[g]);
+    }
+    for (auto g:todo) {
+      best_x.push_back(hint_ub[g]);
+    }
+    double q;
+    int64_t iprime;
+    std::vector<double> errs, xhats, lb, ub;
+    LP_preset(dist, preset, err, q, iprime, errs, xhats);
+    LP_curve_both(dist, level_Gs, q, iprime, errs, xhats, true, true, lb, ub, best_x);
+    if (lb.empty()) {
+      return lp_progressive_result();
+    }
+
+    int64_t n_level = todo.size();
+    std::vector<int64_t> next;
+    for (int64_t t=0; t<n_level; ++t) {
+      int64_t g = todo[t];
+      res.lb[g] = lb[t];
+      res.ub[g] = ub[t];
+      res.preset[g] = preset;
+      if ((int64_t) best_x.size() == 2 * n_level) {
+        hint_lb[g] = best_x[t];
+        hint_ub[g] = best_x[n_level + t];
+      }
+      if (lb[t] >= 0 && ub[t] >= 0 && ub[t] - lb[t] > gap) {
+        next.push_back(g);
+      }
+    }
+    todo.swap(next);
+    if (todo.empty()) {
+      break;
+    }
+  }
+  return res;
+}
+
+/*
+按数据集校准LP参数：q和iprime（即LP的规模）固定为preset的值，从preset的xhats、errs出发，搜索使Gs上UB - LB的平均值最小的xhats和errs
+  每一轮把每个xhat_i、每个err_i分别乘上(1+step)或1/(1+step)（errs再缩放回preset的总和，总错误率不变），
+  所有候选并行求值，取最好的一个；没有改进时step减半，step小于LP_CALIBRATE_MIN_STEP时结束
+  LB、UB用阈值形式求（见LP_threshold_curve），候选之间共用网格和bpdf系数
+  结果存入dist，之后preset "calibrated"使用它（可以用save_lp_params保存）；
+  返回达到的平均gap，参数不合法时返回-1，preset的参数已经不可行时返回-2
+*/
+static const int64_t LP_CALIBRATE_ROUNDS = 32;
+static const double LP_CALIBRATE_STEP = 0.2;
+static const double LP_CALIBRATE_MIN_STEP = 0.01;
+static const double LP_CALIBRATE_TOL = 1e-6; // relative improvement needed to accept a candidate
+static const double LP_PARAMS_SUM_TOL = 1e-9; // relative round-off allowed on the errs sum of a parameter file
+
+// 校准的目标：Gs上UB - LB的平均值，不可行或出错时为inf
+static double LP_calibration_gap(dist_t& dist, std::vector<int64_t>& Gs, std::vector<double>& mesh, double q, int64_t iprime, std::vector<double>& errs, std::vector<double>& xhats) {
+  const double inf = std::numeric_limits<double>::infinity();
+  std::vector<double> eps2s, eps3s, lb, ub;
+  std::vector<bool> feasible;
+  LP_eps(dist, q, iprime, errs, xhats, eps2s, eps3s);
+  try {
+    if (!LP_threshold_curve(dist, Gs, mesh, q, iprime, eps2s, eps3s, xhats, false, lb, feasible) || !feasible[0]) {
+      return inf;
+    }
+    if (!LP_threshold_curve(dist, Gs, mesh, q, iprime, eps2s, eps3s, xhats, true, ub, feasible) || !feasible[0]) {
+      return inf;
+    }
+  } catch(const lp_error& e) {
+    return inf;
+  }
+  double sum = 0.0;
+  for (size_t g=0; g<Gs.size(); ++g) {
+    sum += std::min(ub[g], 1.0) - std::max(lb[g], 0.0);
+  }
+  return sum / Gs.size();
+}
+
+double LP_calibrate(dist_t& dist, std::vector<int64_t> Gs, double err, std::string preset) {
+  if (!error_check_basic(dist, Gs, err)) {
+    return -1;
+  }
+  prof_span span("LP calibrate", "Gs", (double) Gs.size());
+
+  const double inf = std::numeric_limits<double>::infinity();
+  double q;
+  int64_t iprime;
+  std::vector<double> errs, xhats;
+  LP_preset(dist, preset, err, q, iprime, errs, xhats);
+  double err_sum = std::accumulate(errs.begin(), errs.end(), 0.0);
+  std::vector<double> mesh = make_mesh(dist.N, q);
+  // shared by all candidates, filled before the threads start
+  populate_logs(dist.N);
+  good_turing_estimates(dist, iprime+1);
+  get_bpdf_table(dist.N, mesh, iprime);
+
+  double best = LP_calibration_gap(dist, Gs, mesh, q, iprime, errs, xhats);
+  if (best == inf) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: LP is infeasible with the " << preset << " parameters, nothing to calibrate.]" << std::endl;
+    }
+    return -2;
+  }
+
+  double step = LP_CALIBRATE_STEP;
+  for (int64_t round=0; round<LP_CALIBRATE_ROUNDS && step >= LP_CALIBRATE_MIN_STEP; ++round) {
+    std::vector<std::vector<double>> cand_errs, cand_xhats;
+    for (int64_t i=0; i<=iprime; ++i) {
+      for (double f:{1.0 + step, 1.0 / (1.0 + step)}) {
+        if (xhats[i] * f * q < 1.0) {
+          cand_errs.push_back(errs);
+          cand_xhats.push_back(xhats);
+          cand_xhats.back()[i] *= f;
+        }
+        std::vector<double> e = errs;
+        e[i] *= f;
+        double sum = std::accumulate(e.begin(), e.end(), 0.0);
+        for (auto& x:e) {
+          x *= err_sum / sum;
+        }
+        cand_errs.push_back(e);
+        cand_xhats.push_back(xhats);
+      }
+    }
+
+    int64_t n_cand = cand_errs.size();
+    std::vector<double> gaps(n_cand);
+    thread_split split = split_threads(dist, n_cand, "calibration candidates");
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(split.outer)
+    for (int64_t c=0; c<n_cand; ++c) {
+      thread_job job(split);
+      prof_span span("calibration candidate", "candidate", (double) c);
+      gaps[c] = LP_calibration_gap(dist, Gs, mesh, q, iprime, cand_errs[c], cand_xhats[c]);
+    }
+
+    int64_t c = std::min_element(gaps.begin(), gaps.end()) - gaps.begin();
+    if (gaps[c] < best * (1.0 - LP_CALIBRATE_TOL)) {
+      best = gaps[c];
+      errs = cand_errs[c];
+      xhats = cand_xhats[c];
+    }
+    else {
+      step /= 2;
+    }
+  }
+
+  dist.lp_q = q;
+  dist.lp_iprime = iprime;
+  clear_memo(dist);
+  dist.lp_xhats.clear();
+  dist.lp_errs.clear();
+  for (auto x:xhats) {
+    dist.lp_xhats.push_back(x * dist.N);
+  }
+  for (auto x:errs) {
+    dist.lp_errs.push_back(x / err);
+  }
+  return best;
+}
+
+/*
+校准参数的文件格式：每行一个参数名加上它的值，#开头的行是注释
+  q 1.002
+  iprime 4
+  xhats 7 11 14 16.3 18.5        （以1/N为单位）
+  errs 0.009 0.0165 0.175 ...    （以err为单位）
+*/
+bool save_lp_params(dist_t& dist, std::string filename) {
+  if (dist.lp_q <= 1) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: No calibrated LP parameters to save.]" << std::endl;
+    }
+    return false;
+  }
+  std::ofstream out(filename);
+  if (!out) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: Cannot open " << filename << " for writing.]" << std::endl;
+    }
+    return false;
+  }
+  out << std::setprecision(17);
+  out << "# LP parameters calibrated on " << dist.filename << ", N = " << dist.N << "\n";
+  out << "q " << dist.lp_q << "\n";
+  out << "iprime " << dist.lp_iprime << "\n";
+  out << "xhats";
+  for (auto x:dist.lp_xhats) {
+    out << " " << x;
+  }
+  out << "\nerrs";
+  for (auto x:dist.lp_errs) {
+    out << " " << x;
+  }
+  out << "\n";
+  return (bool) out;
+}
+
+bool load_lp_params(dist_t& dist, std::string filename) {
+  if (dist.N == 0) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: Read the sample before loading LP parameters, xhats are checked against its N.]" << std::endl;
+    }
+    return false;
+  }
+  std::ifstream in(filename);
+  if (!in) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: Cannot open " << filename << ".]" << std::endl;
+    }
+    return false;
+  }
+  double q = 0;
+  int64_t iprime = -1;
+  std::vector<double> xhats, errs;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream ss(line);
+    std::string key;
+    if (!(ss >> key) || key[0] == '#') {
+      continue;
+    }
+    double x;
+    if (key == "q") {
+      ss >> q;
+    }
+    else if (key == "iprime") {
+      ss >> iprime;
+    }
+    else if (key == "xhats") {
+      while (ss >> x) {
+        xhats.push_back(x);
+      }
+    }
+    else if (key == "errs") {
+      while (ss >> x) {
+        errs.push_back(x);
+      }
+    }
+  }
+  // errs are in units of err and must stay below 1, or the logs in the bounds of constraint (2) become NaN;
+  // like the presets and LP_calibrate they may spend at most err/2 in total, or the confidence drops below 1 - err.
+  // xhats are in units of 1/N, LP_calibrate keeps every xhat * q below 1
+  double err_sum = std::accumulate(errs.begin(), errs.end(), 0.0);
+  bool in_range = std::all_of(xhats.begin(), xhats.end(), [&](double x) { return x > 0 && x * q < dist.N; })
+               && std::all_of(errs.begin(), errs.end(), [](double x) { return x > 0 && x < 1; })
+               && err_sum <= 0.5 * (1.0 + LP_PARAMS_SUM_TOL);
+  if (!(q > 1) || !std::isfinite(q) || iprime < 0 || (int64_t) xhats.size() != iprime + 1 || (int64_t) errs.size() != iprime + 1 || !in_range) {
+    if (dist.verbose) {
+      std::cerr << "\n[Error: " << filename << " is not a valid LP parameter file.]" << std::endl;
+    }
+    return false;
+  }
+  dist.lp_q = q;
+  dist.lp_iprime = iprime;
+  clear_memo(dist);
+  dist.lp_xhats = xhats;
+  dist.lp_errs = errs;
+  return true;
+}
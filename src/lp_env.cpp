@@ -0,0 +1,46 @@
+#include "lp_env.hpp"
+
+#include <iostream>
+#include <memory>
+#include <atomic>
+
+#include "profiler.hpp"
+
+static std::atomic<int64_t> envs_created(0);
+static std::atomic<int64_t> envs_reused(0);
+
+#ifdef HAVE_GUROBI
+// thread_local: Gurobi environments must not be shared between threads
+static thread_local std::unique_ptr<GRBEnv> thread_env;
+
+GRBEnv& pooled_env() {
+  if (thread_env) {
+    envs_reused++;
+    return *thread_env;
+  }
+  prof_span span("gurobi env start");
+  std::unique_ptr<GRBEnv> env(new GRBEnv(true));
+  env->set(GRB_IntParam_OutputFlag, 0);
+  env->start();
+  thread_env = std::move(env);
+  envs_created++;
+  return *thread_env;
+}
+#endif
+
+env_pool_stats get_env_pool_stats() {
+  env_pool_stats stats;
+  stats.created = envs_created.load();
+  stats.reused = envs_reused.load();
+  return stats;
+}
+
+void reset_env_pool_stats() {
+  envs_created = 0;
+  envs_reused = 0;
+}
+
+void print_env_pool_stats() {
+  env_pool_stats stats = get_env_pool_stats();
+  std::cout << "[Info] Gurobi envs created: " << stats.created << "; reused: " << stats.reused << std::endl;
+}
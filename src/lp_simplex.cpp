@@ -0,0 +1,605 @@
+#include "lp_simplex.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+static const double INF = std::numeric_limits<double>::infinity();
+static const double PIVOT_TOL = 1e-11; // smallest usable pivot in the ratio test
+static const int REFACTOR_EVERY = 50;  // recompute B^{-1} and x_B from scratch
+static const int BLAND_AFTER = 100;    // consecutive degenerate pivots before switching to Bland's rule
+
+int simplex_lp::add_var(double lb, double ub, double c) {
+  A.resize(A.size() + m, 0.0);
+  obj.push_back(c);
+  var_lb.push_back(lb);
+  var_ub.push_back(ub);
+  // logicals sit behind the structurals in state/x, shift them by one
+  state.insert(state.begin() + n, AT_LB);
+  x.insert(x.begin() + n, 0.0);
+  for (auto& k:head) {
+    if (k >= n) {
+      ++k;
+    }
+  }
+  return n++;
+}
+
+int simplex_lp::add_row(double lo, double hi, const std::vector<int>& vars, const std::vector<double>& vals) {
+  std::vector<double> B(A.size() + n, 0.0);
+  for (int j=0; j<n; ++j) {
+    std::copy(A.begin() + (int64_t) j * m, A.begin() + (int64_t) (j + 1) * m, B.begin() + (int64_t) j * (m + 1));
+  }
+  A.swap(B);
+  ++m;
+  for (int t=0; t<(int) vars.size(); ++t) {
+    A[(int64_t) vars[t] * m + (m - 1)] = vals[t];
+  }
+  row_lo.push_back(lo);
+  row_hi.push_back(hi);
+  row_scale.push_back(1.0);
+  row_scaled.push_back(vars.empty()); // empty rows are never scaled, see scale_model
+  // the new logical enters the basis, the extended basis stays nonsingular
+  state.push_back(BASIC);
+  x.push_back(0.0);
+  head.push_back(n + m - 1);
+  return m - 1;
+}
+
+void simplex_lp::set_coeff(int row, int var, double val) {
+  A[(int64_t) var * m + row] = val * row_scale[row];
+}
+
+void simplex_lp::set_obj(int var, double val) {
+  obj[var] = val;
+}
+
+void simplex_lp::set_row_bounds(int row, double lo, double hi) {
+  row_lo[row] = lo * row_scale[row];
+  row_hi[row] = hi * row_scale[row];
+}
+
+void simplex_lp::set_maximize(bool max) {
+  maximize = max;
+}
+
+void simplex_lp::set_cutoff(double c) {
+  cutoff = c;
+}
+
+void simplex_lp::set_tolerance(double tol) {
+  feas_tol = tol;
+  opt_tol = tol;
+}
+
+// factors already chosen stay in place, so switching it off only affects rows added later
+void simplex_lp::set_scaling(bool on) {
+  scaling = on;
+}
+
+double simplex_lp::objective() {
+  return objval;
+}
+
+double simplex_lp::value(int var) {
+  return x[var];
+}
+
+double simplex_lp::reduced_cost(int var) {
+  double d = cost(var, false);
+  for (int r=0; r<m; ++r) {
+    d -= duals[r] * A[(int64_t) var * m + r];
+  }
+  return maximize ? -d : d;
+}
+
+double simplex_lp::dual(int row) {
+  double y = duals[row] * row_scale[row];
+  return maximize ? -y : y;
+}
+
+void simplex_lp::reset() {
+  has_basis = false;
+}
+
+int64_t simplex_lp::iterations() {
+  return iters;
+}
+
+double simplex_lp::col(int k, int r) const {
+  if (k < n) {
+    return A[(int64_t) k * m + r];
+  }
+  return (k - n == r) ? -1.0 : 0.0;
+}
+
+// stored value times unit(k) is the value in the original model; the tolerances are scaled by it, see scale_model
+double simplex_lp::unit(int k) const {
+  return (k < n) ? 1.0 : 1.0 / row_scale[k - n];
+}
+
+double simplex_lp::lo(int k) const {
+  return (k < n) ? var_lb[k] : row_lo[k - n];
+}
+
+double simplex_lp::hi(int k) const {
+  return (k < n) ? var_ub[k] : row_hi[k - n];
+}
+
+double simplex_lp::cost(int k, bool phase1) const {
+  if (phase1 || k >= n) {
+    return 0.0;
+  }
+  return maximize ? -obj[k] : obj[k];
+}
+
+/*
+行缩放：第一次求解前（以及之后新加的行）把每一行按最大的系数缩放到[1, 2)，因子取2的幂，缩放本身没有舍入误差
+  缩放后各行系数的最大值都在[1, 2)，相差很多的是行内各列之间（网格上的bpdf），行与行之间的量级一致
+  只缩放add_row时带系数的行；建成空行、之后由set_coeff填的行（LP_sweep的约束(1)(4)）系数随idx重写，
+  按第一次的系数定的因子之后可能差很多个数量级，这些行的量级由调用方自己控制（约束(1)的scale）
+  列不缩放：列的量级主要来自网格点x_j，定价已经按列的范数归一化，试过的列缩放只增加迭代次数
+*/
+void simplex_lp::scale_model() {
+  if (std::find(row_scaled.begin(), row_scaled.end(), false) == row_scaled.end()) {
+    return;
+  }
+  std::vector<double> rmax(m, 0.0);
+  for (int j=0; j<n; ++j) {
+    for (int r=0; r<m; ++r) {
+      rmax[r] = std::max(rmax[r], fabs(A[(int64_t) j * m + r]));
+    }
+  }
+  for (int r=0; r<m; ++r) {
+    if (!row_scaled[r] && rmax[r] > 0.0) {
+      scale_row(r, exp2(-floor(log2(rmax[r]))));
+    }
+    row_scaled[r] = true;
+  }
+}
+
+void simplex_lp::scale_row(int r, double f) {
+  for (int j=0; j<n; ++j) {
+    A[(int64_t) j * m + r] *= f;
+  }
+  row_lo[r] *= f;
+  row_hi[r] *= f;
+  x[n + r] *= f;
+  row_scale[r] *= f;
+}
+
+void simplex_lp::slack_basis() {
+  head.resize(m);
+  for (int k=0; k<n+m; ++k) {
+    state[k] = (k < n) ? AT_LB : BASIC;
+  }
+  for (int r=0; r<m; ++r) {
+    head[r] = n + r;
+  }
+  has_basis = true;
+}
+
+// put every nonbasic variable on one of its (finite) bounds
+void simplex_lp::snap_nonbasic() {
+  for (int k=0; k<n+m; ++k) {
+    if (state[k] == BASIC) {
+      continue;
+    }
+    double l = lo(k), u = hi(k);
+    if (state[k] == AT_UB && u == INF) {
+      state[k] = AT_LB;
+    }
+    if (state[k] == AT_LB && l == -INF) {
+      state[k] = (u < INF) ? AT_UB : AT_ZERO;
+    }
+    if (state[k] == AT_ZERO && l > -INF) {
+      state[k] = AT_LB;
+    }
+    x[k] = (state[k] == AT_LB) ? l : (state[k] == AT_UB) ? u : 0.0;
+  }
+}
+
+// Gauss-Jordan inverse of the basis matrix with partial pivoting
+bool simplex_lp::factor() {
+  std::vector<double> B((int64_t) m * m);
+  for (int i=0; i<m; ++i) {
+    for (int r=0; r<m; ++r) {
+      B[(int64_t) r * m + i] = col(head[i], r);
+    }
+  }
+  Binv.assign((int64_t) m * m, 0.0);
+  for (int r=0; r<m; ++r) {
+    Binv[(int64_t) r * m + r] = 1.0;
+  }
+  for (int c=0; c<m; ++c) {
+    int piv = c;
+    for (int r=c+1; r<m; ++r) {
+      if (fabs(B[(int64_t) r * m + c]) > fabs(B[(int64_t) piv * m + c])) {
+        piv = r;
+      }
+    }
+    if (fabs(B[(int64_t) piv * m + c]) < 1e-14) {
+      return false;
+    }
+    if (piv != c) {
+      for (int t=0; t<m; ++t) {
+        std::swap(B[(int64_t) piv * m + t], B[(int64_t) c * m + t]);
+        std::swap(Binv[(int64_t) piv * m + t], Binv[(int64_t) c * m + t]);
+      }
+    }
+    double d = 1.0 / B[(int64_t) c * m + c];
+    for (int t=0; t<m; ++t) {
+      B[(int64_t) c * m + t] *= d;
+      Binv[(int64_t) c * m + t] *= d;
+    }
+    for (int r=0; r<m; ++r) {
+      double f = B[(int64_t) r * m + c];
+      if (r == c || f == 0.0) {
+        continue;
+      }
+      for (int t=0; t<m; ++t) {
+        B[(int64_t) r * m + t] -= f * B[(int64_t) c * m + t];
+        Binv[(int64_t) r * m + t] -= f * Binv[(int64_t) c * m + t];
+      }
+    }
+  }
+  return true;
+}
+
+// x_B = B^{-1} (-N x_N)
+void simplex_lp::compute_xB() {
+  std::vector<double> rhs(m, 0.0);
+  for (int j=0; j<n; ++j) {
+    if (state[j] != BASIC && x[j] != 0.0) {
+      const double* a = &A[(int64_t) j * m];
+      for (int r=0; r<m; ++r) {
+        rhs[r] -= a[r] * x[j];
+      }
+    }
+  }
+  for (int r=0; r<m; ++r) {
+    if (state[n + r] != BASIC) {
+      rhs[r] += x[n + r];
+    }
+  }
+  for (int i=0; i<m; ++i) {
+    double v = 0.0;
+    for (int r=0; r<m; ++r) {
+      v += Binv[(int64_t) i * m + r] * rhs[r];
+    }
+    x[head[i]] = v;
+  }
+}
+
+// signed bound violation of the variable basic in position i
+double simplex_lp::infeasibility(int i) const {
+  int k = head[i];
+  double tol = feas_tol / unit(k);
+  if (x[k] < lo(k) - tol) {
+    return x[k] - lo(k);
+  }
+  if (x[k] > hi(k) + tol) {
+    return x[k] - hi(k);
+  }
+  return 0.0;
+}
+
+int simplex_lp::solve() {
+  iters = 0;
+  objval = 0.0;
+  bool warm = has_basis; // a warm basis can be badly conditioned after the bounds changed, see below
+  if (scaling) {
+    scale_model();
+  }
+  if (!has_basis) {
+    slack_basis();
+  }
+  snap_nonbasic();
+  if (!factor()) {
+    slack_basis();
+    snap_nonbasic();
+    factor();
+    warm = false;
+  }
+  compute_xB();
+
+  std::vector<double> norm2(n + m); // static column weights for normalized pricing
+  for (int j=0; j<n; ++j) {
+    double s = 1.0;
+    for (int r=0; r<m; ++r) {
+      s += A[(int64_t) j * m + r] * A[(int64_t) j * m + r];
+    }
+    norm2[j] = s;
+  }
+  for (int r=0; r<m; ++r) {
+    norm2[n + r] = 2.0;
+  }
+
+  std::vector<double> cB(m), y(m), alpha(m);
+  int64_t max_iters = 100 * (int64_t) (n + m) + 10000;
+  int degenerate = 0;
+  int since_factor = 0;
+
+  while (iters < max_iters) {
+    if (since_factor >= REFACTOR_EVERY) {
+      if (!factor()) {
+        return LP_OTHER;
+      }
+      compute_xB();
+      since_factor = 0;
+    }
+
+    bool phase1 = false;
+    for (int i=0; i<m; ++i) {
+      if (infeasibility(i) != 0.0) {
+        phase1 = true;
+        break;
+      }
+    }
+
+    // duals y = c_B B^{-1}; in phase 1 c_B is the gradient of the sum of infeasibilities
+    for (int i=0; i<m; ++i) {
+      if (phase1) {
+        double inf = infeasibility(i);
+        cB[i] = (inf < 0) ? -1.0 : (inf > 0) ? 1.0 : 0.0;
+      }
+      else {
+        cB[i] = cost(head[i], false);
+      }
+    }
+    for (int r=0; r<m; ++r) {
+      double v = 0.0;
+      for (int i=0; i<m; ++i) {
+        v += cB[i] * Binv[(int64_t) i * m + r];
+      }
+      y[r] = v;
+    }
+
+    // pricing
+    bool bland = degenerate >= BLAND_AFTER;
+    bool check_cutoff = !phase1 && std::isfinite(cutoff);
+    double min_cutoff = maximize ? -cutoff : cutoff; // cost() works in the minimization sense
+    double lagrangian = 0.0; // min over the bounds of (c - yA) x + y s, a lower bound of the optimum
+    int q = -1;
+    int dir = 0;
+    double best = 0.0;
+    for (int k=0; k<n+m; ++k) {
+      if (state[k] == BASIC || (lo(k) == hi(k) && !check_cutoff)) {
+        continue;
+      }
+      double d;
+      if (k < n) {
+        d = cost(k, phase1);
+        const double* a = &A[(int64_t) k * m];
+        for (int r=0; r<m; ++r) {
+          d -= y[r] * a[r];
+        }
+      }
+      else {
+        d = y[k - n];
+      }
+      if (check_cutoff) {
+        if (d > 0) {
+          lagrangian += d * lo(k);
+        }
+        else if (d < 0) {
+          lagrangian += d * hi(k);
+        }
+        if (lo(k) == hi(k)) {
+          continue;
+        }
+      }
+      int kdir = 0;
+      double tol = phase1 ? opt_tol : opt_tol * unit(k); // the phase 1 objective is in stored units
+      if (state[k] == AT_LB && d < -tol) {
+        kdir = 1;
+      }
+      else if (state[k] == AT_UB && d > tol) {
+        kdir = -1;
+      }
+      else if (state[k] == AT_ZERO && fabs(d) > tol) {
+        kdir = (d < 0) ? 1 : -1;
+      }
+      if (kdir == 0) {
+        continue;
+      }
+      double score = d * d / norm2[k];
+      if (score > best) {
+        best = score;
+        q = k;
+        dir = kdir;
+        if (bland) {
+          break;
+        }
+      }
+    }
+
+    if (check_cutoff && lagrangian - min_cutoff > opt_tol * (1.0 + fabs(min_cutoff))) {
+      duals = y; // the duals behind the cutoff, see dual()
+      return LP_CUTOFF;
+    }
+
+    if (q < 0) {
+      if (phase1 && warm) {
+        // phase 1 stalled on a warm basis: confirm from the slack basis before reporting infeasibility
+        slack_basis();
+        snap_nonbasic();
+        factor();
+        compute_xB();
+        since_factor = 0;
+        degenerate = 0;
+        warm = false;
+        continue;
+      }
+      if (phase1) {
+        return LP_INFEASIBLE;
+      }
+      // confirm optimality on a fresh factorization before reporting it
+      if (since_factor > 0) {
+        if (!factor()) {
+          return LP_OTHER;
+        }
+        compute_xB();
+        since_factor = 0;
+        bool still_feasible = true;
+        for (int i=0; i<m; ++i) {
+          if (infeasibility(i) != 0.0) {
+            still_feasible = false;
+          }
+        }
+        if (!still_feasible) {
+          continue;
+        }
+      }
+      objval = 0.0;
+      for (int j=0; j<n; ++j) {
+        objval += obj[j] * x[j];
+      }
+      duals = y;
+      return LP_OPTIMAL;
+    }
+
+    // alpha = B^{-1} a_q, x_B moves by -dir * t * alpha
+    for (int i=0; i<m; ++i) {
+      double v = 0.0;
+      if (q < n) {
+        const double* a = &A[(int64_t) q * m];
+        for (int r=0; r<m; ++r) {
+          v += Binv[(int64_t) i * m + r] * a[r];
+        }
+      }
+      else {
+        v = -Binv[(int64_t) i * m + (q - n)];
+      }
+      alpha[i] = v;
+    }
+
+    // ratio test (Harris): pass 1 finds the relaxed step, pass 2 the largest pivot within it
+    double t_flip = hi(q) - lo(q); // inf unless both bounds are finite
+    double t_relaxed = INF;
+    for (int i=0; i<m; ++i) {
+      double rate = -dir * alpha[i];
+      if (fabs(alpha[i]) < PIVOT_TOL) {
+        continue;
+      }
+      int k = head[i];
+      double inf = phase1 ? infeasibility(i) : 0.0;
+      double tol = feas_tol / unit(k);
+      double bound = INF;
+      if (inf < 0) { // below lb, blocks when it becomes feasible
+        if (rate > 0) {
+          bound = (lo(k) - x[k] + tol) / rate;
+        }
+      }
+      else if (inf > 0) { // above ub
+        if (rate < 0) {
+          bound = (x[k] - hi(k) + tol) / -rate;
+        }
+      }
+      else if (rate < 0 && lo(k) > -INF) {
+        bound = (x[k] - lo(k) + tol) / -rate;
+      }
+      else if (rate > 0 && hi(k) < INF) {
+        bound = (hi(k) - x[k] + tol) / rate;
+      }
+      t_relaxed = std::min(t_relaxed, bound);
+    }
+
+    int p = -1;
+    double t = INF;
+    bool leave_at_ub = false;
+    double best_pivot = 0.0;
+    if (t_relaxed < INF) {
+      for (int i=0; i<m; ++i) {
+        double rate = -dir * alpha[i];
+        if (fabs(alpha[i]) < PIVOT_TOL) {
+          continue;
+        }
+        int k = head[i];
+        double inf = phase1 ? infeasibility(i) : 0.0;
+        double ratio = INF;
+        bool at_ub = false;
+        if (inf < 0) {
+          if (rate > 0) {
+            ratio = (lo(k) - x[k]) / rate;
+          }
+        }
+        else if (inf > 0) {
+          if (rate < 0) {
+            ratio = (x[k] - hi(k)) / -rate;
+            at_ub = true;
+          }
+        }
+        else if (rate < 0 && lo(k) > -INF) {
+          ratio = (x[k] - lo(k)) / -rate;
+        }
+        else if (rate > 0 && hi(k) < INF) {
+          ratio = (hi(k) - x[k]) / rate;
+          at_ub = true;
+        }
+        if (ratio > t_relaxed) {
+          continue;
+        }
+        bool better = bland ? (p < 0 || head[i] < head[p]) : (fabs(alpha[i]) > best_pivot);
+        if (better) {
+          p = i;
+          t = std::max(ratio, 0.0);
+          leave_at_ub = at_ub;
+          best_pivot = fabs(alpha[i]);
+        }
+      }
+    }
+
+    if (t_flip <= t) { // bound flip, the basis does not change
+      if (t_flip == INF) {
+        return LP_OTHER; // unbounded
+      }
+      for (int i=0; i<m; ++i) {
+        x[head[i]] -= dir * t_flip * alpha[i];
+      }
+      state[q] = (dir > 0) ? AT_UB : AT_LB;
+      x[q] = (dir > 0) ? hi(q) : lo(q);
+      ++iters;
+      degenerate = 0;
+      continue;
+    }
+    if (p < 0) {
+      return LP_OTHER;
+    }
+
+    // pivot: q enters in position p, head[p] leaves at the bound it reached
+    for (int i=0; i<m; ++i) {
+      x[head[i]] -= dir * t * alpha[i];
+    }
+    x[q] += dir * t;
+    int leaving = head[p];
+    state[leaving] = leave_at_ub ? AT_UB : AT_LB;
+    x[leaving] = leave_at_ub ? hi(leaving) : lo(leaving);
+    head[p] = q;
+    state[q] = BASIC;
+
+    double piv = alpha[p];
+    for (int r=0; r<m; ++r) {
+      Binv[(int64_t) p * m + r] /= piv;
+    }
+    for (int i=0; i<m; ++i) {
+      if (i == p || alpha[i] == 0.0) {
+        continue;
+      }
+      double f = alpha[i];
+      for (int r=0; r<m; ++r) {
+        Binv[(int64_t) i * m + r] -= f * Binv[(int64_t) p * m + r];
+      }
+    }
+
+    ++iters;
+    ++since_factor;
+    degenerate = (t == 0.0) ? degenerate + 1 : 0;
+  }
+
+  return LP_OTHER;
+}
+
+std::unique_ptr<lp_backend> make_simplex_backend() {
+  return std::unique_ptr<lp_backend>(new simplex_lp());
+}
@@ -0,0 +1,281 @@
+#include "profiler.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdlib>
+
+constexpr size_t PROF_MAX_EVENTS = 1 << 20; // per thread
+
+std::atomic<bool> profiling_on{false};
+
+struct prof_event {
+  const char* name;
+  const char* arg_name;
+  double arg;
+  int64_t start; // ns
+  int64_t dur; // ns
+};
+
+struct prof_total {
+  int64_t count = 0;
+  int64_t total = 0; // ns
+  int64_t self = 0; // ns, total minus the time of nested spans
+  int64_t max = 0; // ns
+};
+
+// 一个线程的缓冲区：只有本线程写，导出时加锁读，锁基本没有竞争
+struct prof_thread {
+  int tid = 0;
+  std::mutex m;
+  std::vector<prof_event> events;
+  int64_t dropped = 0;
+  std::unordered_map<const char*, prof_total> spans;
+  std::unordered_map<const char*, int64_t> counters;
+  std::vector<int64_t> nested; // time of finished child spans, one per open span
+};
+
+static std::mutex registry_mutex;
+static std::vector<std::shared_ptr<prof_thread>> registry;
+static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+static int64_t enabled_at = 0;
+
+static int64_t now_ns() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+static prof_thread& local_buffer() {
+  thread_local std::shared_ptr<prof_thread> buffer;
+  if (!buffer) {
+    buffer = std::make_shared<prof_thread>();
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    buffer->tid = (int) registry.size() + 1;
+    registry.push_back(buffer);
+  }
+  return *buffer;
+}
+
+void prof_span::begin(const char* name_, const char* arg_name_, double arg_) {
+  name = name_;
+  arg_name = arg_name_;
+  arg = arg_;
+  local_buffer().nested.push_back(0);
+  start = now_ns();
+}
+
+void prof_span::end() {
+  int64_t dur = now_ns() - start;
+  prof_thread& buf = local_buffer();
+  std::lock_guard<std::mutex> lock(buf.m);
+  int64_t child = 0;
+  // reset_profile() clears the stack of open spans; such a span still records its own time
+  if (!buf.nested.empty()) {
+    child = buf.nested.back();
+    buf.nested.pop_back();
+  }
+  if (!buf.nested.empty()) {
+    buf.nested.back() += dur;
+  }
+  prof_total& t = buf.spans[name];
+  t.count++;
+  t.total += dur;
+  t.self += dur - child;
+  t.max = std::max(t.max, dur);
+  if (buf.events.size() < PROF_MAX_EVENTS) {
+    buf.events.push_back({name, arg_name, arg, start, dur});
+  } else {
+    buf.dropped++;
+  }
+}
+
+void prof_count(const char* name, int64_t n) {
+  if (!profiling_enabled()) {
+    return;
+  }
+  prof_thread& buf = local_buffer();
+  std::lock_guard<std::mutex> lock(buf.m);
+  buf.counters[name] += n;
+}
+
+void enable_profiling(bool on) {
+  if (on && !profiling_enabled()) {
+    enabled_at = now_ns();
+  }
+  profiling_on.store(on, std::memory_order_relaxed);
+}
+
+void reset_profile() {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (auto& buf:registry) {
+    std::lock_guard<std::mutex> buf_lock(buf->m);
+    buf->events.clear();
+    buf->dropped = 0;
+    buf->spans.clear();
+    buf->counters.clear();
+    std::fill(buf->nested.begin(), buf->nested.end(), 0);
+  }
+  enabled_at = now_ns();
+}
+
+// 所有线程的汇总，同名（内容相同、指针不同）的合并
+struct prof_summary {
+  std::map<std::string, prof_total> spans;
+  std::map<std::string, int64_t> counters;
+  int threads = 0;
+  int64_t events = 0;
+  int64_t dropped = 0;
+};
+
+static prof_summary summarize() {
+  prof_summary s;
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (auto& buf:registry) {
+    std::lock_guard<std::mutex> buf_lock(buf->m);
+    if (buf->spans.empty() && buf->counters.empty()) {
+      continue;
+    }
+    s.threads++;
+    s.events += (int64_t) buf->events.size();
+    s.dropped += buf->dropped;
+    for (auto& [name, t]:buf->spans) {
+      prof_total& u = s.spans[name];
+      u.count += t.count;
+      u.total += t.total;
+      u.self += t.self;
+      u.max = std::max(u.max, t.max);
+    }
+    for (auto& [name, n]:buf->counters) {
+      s.counters[name] += n;
+    }
+  }
+  return s;
+}
+
+static std::vector<std::pair<std::string, prof_total>> by_total(const prof_summary& s) {
+  std::vector<std::pair<std::string, prof_total>> spans(s.spans.begin(), s.spans.end());
+  std::stable_sort(spans.begin(), spans.end(), [](auto& a, auto& b) { return a.second.total > b.second.total; });
+  return spans;
+}
+
+static std::string json_string(const std::string& str) {
+  std::string out = "\"";
+  for (char c:str) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    out += c;
+  }
+  return out + "\"";
+}
+
+static double seconds(int64_t ns) {
+  return ns * 1e-9;
+}
+
+bool write_profile_json(const std::string& filename) {
+  prof_summary s = summarize();
+  std::ofstream file(filename);
+  if (!file) {
+    std::cerr << "\n[Error: cannot write profile to " << filename << "]" << std::endl;
+    return false;
+  }
+  file << std::setprecision(9);
+  file << "{\n  \"wall_seconds\": " << seconds(now_ns() - enabled_at)
+       << ",\n  \"threads\": " << s.threads << ",\n  \"events\": " << s.events << ",\n  \"dropped_events\": " << s.dropped
+       << ",\n  \"spans\": [";
+  bool first = true;
+  for (auto& [name, t]:by_total(s)) {
+    file << (first ? "\n" : ",\n") << "    {\"name\": " << json_string(name) << ", \"count\": " << t.count
+         << ", \"total_seconds\": " << seconds(t.total) << ", \"self_seconds\": " << seconds(t.self)
+         << ", \"mean_seconds\": " << seconds(t.total) / t.count << ", \"max_seconds\": " << seconds(t.max) << "}";
+    first = false;
+  }
+  file << "\n  ],\n  \"counters\": {";
+  first = true;
+  for (auto& [name, n]:s.counters) {
+    file << (first ? "\n" : ",\n") << "    " << json_string(name) << ": " << n;
+    first = false;
+  }
+  file << "\n  }\n}\n";
+  return (bool) file;
+}
+
+// Trace Event Format：完整事件（ph "X"），ts和dur以微秒计，每个线程一条轨道
+bool write_chrome_trace(const std::string& filename) {
+  std::ofstream file(filename);
+  if (!file) {
+    std::cerr << "\n[Error: cannot write trace to " << filename << "]" << std::endl;
+    return false;
+  }
+  file << std::setprecision(15);
+  file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+  file << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, \"args\": {\"name\": \"LPCore\"}}";
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (auto& buf:registry) {
+    std::lock_guard<std::mutex> buf_lock(buf->m);
+    if (buf->events.empty()) {
+      continue;
+    }
+    file << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buf->tid
+         << ", \"args\": {\"name\": \"thread " << buf->tid << "\"}}";
+    for (auto& e:buf->events) {
+      file << ",\n{\"name\": " << json_string(e.name) << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buf->tid
+           << ", \"ts\": " << e.start * 1e-3 << ", \"dur\": " << e.dur * 1e-3;
+      if (e.arg_name) {
+        file << ", \"args\": {" << json_string(e.arg_name) << ": " << e.arg << "}";
+      }
+      file << "}";
+    }
+  }
+  file << "\n]}\n";
+  return (bool) file;
+}
+
+void print_profile() {
+  if (!profiling_enabled()) {
+    return;
+  }
+  prof_summary s = summarize();
+  std::cout << "[Info] profile: " << s.spans.size() << " spans on " << s.threads << " threads";
+  if (s.dropped > 0) {
+    std::cout << ", " << s.dropped << " trace events dropped";
+  }
+  std::cout << std::endl;
+  for (auto& [name, t]:by_total(s)) {
+    std::cout << "  " << std::left << std::setw(24) << name << std::right << std::setw(10) << t.count
+              << std::fixed << std::setprecision(3) << std::setw(12) << seconds(t.total) << " s total"
+              << std::setw(12) << seconds(t.self) << " s self" << std::defaultfloat << std::endl;
+  }
+  for (auto& [name, n]:s.counters) {
+    std::cout << "  " << std::left << std::setw(24) << name << std::right << std::setw(10) << n << std::endl;
+  }
+}
+
+// LP_PROFILE=<路径前缀>：启动时打开剖析，进程退出时写出 <前缀>.json 和 <前缀>.trace.json
+struct prof_env_init {
+  std::string prefix;
+  prof_env_init() {
+    const char* env = std::getenv("LP_PROFILE");
+    if (env && *env) {
+      prefix = env;
+      enable_profiling(true);
+    }
+  }
+  ~prof_env_init() {
+    if (!prefix.empty()) {
+      write_profile_json(prefix + ".json");
+      write_chrome_trace(prefix + ".trace.json");
+    }
+  }
+};
+
+static prof_env_init env_init;
@@ -8,8 +8,11 @@
 #include <cmath>
 #include <algorithm>
 #include "distribution.hpp"
+#include "bound_memo.hpp"
+#include "profiler.hpp"
 
 void parse_freqcount(dist_t& dist, std::vector<std::pair<int64_t, int64_t>>& freqcount) {
+  prof_span span("parse freqcount");
   std::sort(freqcount.rbegin(), freqcount.rend()); // sort descending
 
   std::vector<int64_t> preftotal(freqcount.size(), 0);
@@ -28,9 +31,13 @@ void parse_freqcount(dist_t& dist, std::vector<std::pair<int64_t, int64_t>>& fre
   dist.prefcount = prefcount;
   dist.N = preftotal.back();
   dist.distinct = prefcount.back();
+  dist.good_turing.clear();
+  dist.fingerprint = 0;
+  clear_memo(dist);
 }
 
 bool read_plain(dist_t& dist, std::string filename) {
+  prof_span span("read plain");
   std::ifstream fin(filename);
   if (!fin.is_open()) {
     if (dist.verbose) {
@@ -64,6 +71,7 @@ bool read_plain(dist_t& dist, std::string filename) {
 }
 
 bool read_pwdfreq(dist_t& dist, std::string filename) { // pwd freq seperated with \t
+  prof_span span("read pwdfreq");
   std::ifstream fin(filename);
   if (!fin.is_open()) {
     if (dist.verbose) {
@@ -101,6 +109,7 @@ bool read_pwdfreq(dist_t& dist, std::string filename) { // pwd freq seperated wi
 }
 
 bool read_freqcount(dist_t& dist, std::string filename) {
+  prof_span span("read freqcount");
   std::ifstream fin(filename);
   if (!fin.is_open()) {
     if (dist.verbose) {
@@ -135,6 +144,7 @@ bool read_freqcount(dist_t& dist, std::string filename) {
 }
 
 bool write_freqcount(dist_t& dist, std::string filename) { // each line is (freq count)
+  prof_span span("write freqcount");
   std::ofstream fout(filename);
   if (!fout.is_open()) {
     if (dist.verbose) {
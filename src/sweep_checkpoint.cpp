@@ -0,0 +1,127 @@
+#include "sweep_checkpoint.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+
+#include "bound_cache.hpp"
+#include "profiler.hpp"
+
+static std::string checkpoint_dir(dist_t& dist) {
+  if (dist.checkpoint_dir != "auto") {
+    return dist.checkpoint_dir;
+  }
+  const char* env = std::getenv("LP_CHECKPOINT_DIR");
+  return env ? env : "";
+}
+
+static std::string hexfloat(double x) {
+  char buf[32];
+  snprintf(buf, sizeof(buf), "%a", x);
+  return buf;
+}
+
+bool checkpoint_enabled(dist_t& dist) {
+  return !checkpoint_dir(dist).empty();
+}
+
+void init_checkpoint(dist_t& dist, sweep_checkpoint& ckpt, const std::string& key, int64_t n_G, const std::vector<int64_t>& block_first, const std::vector<int64_t>& block_last) {
+  char name[32];
+  snprintf(name, sizeof(name), "sweep-%016llx.ckpt", (unsigned long long) hash_string(key));
+  ckpt.path = (std::filesystem::path(checkpoint_dir(dist)) / name).string();
+  ckpt.key = key;
+  ckpt.n_G = n_G;
+  ckpt.block_first = block_first;
+  ckpt.block_last = block_last;
+  ckpt.blocks.assign(block_first.size(), sweep_block_state());
+  ckpt.last_write = std::chrono::steady_clock::now();
+}
+
+/*
+文件格式（文本，浮点数为十六进制）：
+  第一行为键；第二行 blocks n_blocks n_G；
+  每块一行 first last started done next reverse，接着n_G行 bmin bmax best bidx bsolved bfeasible have_best
+*/
+bool load_checkpoint(dist_t& dist, sweep_checkpoint& ckpt) {
+  prof_span span("checkpoint load");
+  std::ifstream in(ckpt.path);
+  std::string key, word;
+  if (!in || !std::getline(in, key) || key != ckpt.key) {
+    return false;
+  }
+  int64_t n_G = ckpt.n_G, n_blocks = ckpt.blocks.size(), file_blocks, file_G;
+  if (!(in >> word >> file_blocks >> file_G) || word != "blocks" || file_blocks != n_blocks || file_G != n_G) {
+    return false;
+  }
+  auto read_double = [&](double& x) {
+    std::string s;
+    if (!(in >> s)) {
+      return false;
+    }
+    char* end = nullptr;
+    x = std::strtod(s.c_str(), &end);
+    return end != s.c_str();
+  };
+  std::vector<sweep_block_state> blocks(n_blocks);
+  for (int64_t b=0; b<n_blocks; ++b) {
+    sweep_block_state& st = blocks[b];
+    int64_t first, last, started, done, reverse;
+    if (!(in >> first >> last >> started >> done >> st.next >> reverse) || first != ckpt.block_first[b] || last != ckpt.block_last[b]) {
+      return false;
+    }
+    st.started = started;
+    st.done = done;
+    st.reverse = reverse;
+    if (!st.started) {
+      continue;
+    }
+    st.bmin.resize(n_G);
+    st.bmax.resize(n_G);
+    st.best.resize(n_G);
+    st.bidx.resize(n_G);
+    st.bsolved.resize(n_G);
+    st.bfeasible.resize(n_G);
+    st.have_best.resize(n_G);
+    for (int64_t g=0; g<n_G; ++g) {
+      int64_t bfeasible, have_best;
+      if (!read_double(st.bmin[g]) || !read_double(st.bmax[g]) || !read_double(st.best[g]) || !(in >> st.bidx[g] >> st.bsolved[g] >> bfeasible >> have_best)) {
+        return false;
+      }
+      st.bfeasible[g] = bfeasible;
+      st.have_best[g] = have_best;
+    }
+  }
+  ckpt.blocks = blocks;
+  if (dist.verbose) {
+    std::cerr << "\n[Note: Resuming idx sweep from checkpoint " << ckpt.path << ".]" << std::endl;
+  }
+  return true;
+}
+
+bool save_checkpoint(dist_t& dist, sweep_checkpoint& ckpt) {
+  prof_span span("checkpoint save");
+  std::string text = ckpt.key + "\nblocks " + std::to_string(ckpt.blocks.size()) + " " + std::to_string(ckpt.n_G) + "\n";
+  for (size_t b=0; b<ckpt.blocks.size(); ++b) {
+    sweep_block_state& st = ckpt.blocks[b];
+    text += std::to_string(ckpt.block_first[b]) + " " + std::to_string(ckpt.block_last[b]) + " " + std::to_string(st.started) + " " + std::to_string(st.done) + " " + std::to_string(st.next) + " " + std::to_string(st.reverse) + "\n";
+    if (!st.started) {
+      continue;
+    }
+    for (size_t g=0; g<st.bmin.size(); ++g) {
+      text += hexfloat(st.bmin[g]) + " " + hexfloat(st.bmax[g]) + " " + hexfloat(st.best[g]) + " " + std::to_string(st.bidx[g]) + " " + std::to_string(st.bsolved[g]) + " " + std::to_string((int) st.bfeasible[g]) + " " + std::to_string((int) st.have_best[g]) + "\n";
+    }
+  }
+  ckpt.last_write = std::chrono::steady_clock::now();
+  return write_file_atomic(dist, ckpt.path, text);
+}
+
+void remove_checkpoint(dist_t& dist, sweep_checkpoint& ckpt) {
+  std::error_code ec;
+  std::filesystem::remove(ckpt.path, ec);
+  if (ec && dist.verbose) {
+    std::cerr << "\n[Warning: Cannot remove checkpoint " << ckpt.path << ": " << ec.message() << ".]" << std::endl;
+  }
+}
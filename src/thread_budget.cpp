@@ -0,0 +1,84 @@
+#include "thread_budget.hpp"
+
+#include <iostream>
+#include <mutex>
+#include <algorithm>
+
+#include <omp.h>
+
+static thread_local int job_budget = 0; // 0 outside a thread_job
+
+static std::mutex report_mutex;
+static std::vector<thread_report_entry> report;
+
+thread_split::thread_split(thread_split&& other) noexcept : outer(other.outer), per_job(other.per_job), saved_levels(other.saved_levels) {
+  other.saved_levels = -1;
+}
+
+thread_split::~thread_split() {
+  if (saved_levels >= 0) {
+    omp_set_max_active_levels(saved_levels);
+  }
+}
+
+thread_job::thread_job(const thread_split& split) : saved(job_budget) {
+  job_budget = split.per_job;
+}
+
+thread_job::~thread_job() {
+  job_budget = saved;
+}
+
+int thread_budget(dist_t& dist) {
+  if (job_budget > 0) {
+    return job_budget;
+  }
+  if (omp_in_parallel()) {
+    return 1;
+  }
+  return (dist.threads > 0) ? dist.threads : omp_get_max_threads();
+}
+
+thread_split split_threads(dist_t& dist, int64_t jobs, const std::string& phase) {
+  int budget = thread_budget(dist);
+  thread_split split;
+  split.outer = (int) std::max<int64_t>(std::min<int64_t>(jobs, budget), 1);
+  split.per_job = std::max(budget / split.outer, 1);
+  // a job with more than one thread may run a nested split loop, which needs a second active level;
+  // raised only for the lifetime of this split, see ~thread_split
+  if (split.per_job > 1 && !omp_in_parallel() && omp_get_max_active_levels() < 2) {
+    split.saved_levels = omp_get_max_active_levels();
+    omp_set_max_active_levels(2);
+  }
+
+  std::lock_guard<std::mutex> lock(report_mutex);
+  auto same = [&](const thread_report_entry& e) {
+    return e.phase == phase && e.jobs == jobs && e.budget == budget;
+  };
+  auto it = std::find_if(report.begin(), report.end(), same);
+  if (it == report.end()) {
+    report.push_back({phase, jobs, budget, split.outer, split.per_job, 0});
+    it = report.end() - 1;
+  }
+  it->count++;
+  return split;
+}
+
+std::vector<thread_report_entry> get_thread_report() {
+  std::lock_guard<std::mutex> lock(report_mutex);
+  return report;
+}
+
+void reset_thread_report() {
+  std::lock_guard<std::mutex> lock(report_mutex);
+  report.clear();
+}
+
+void print_thread_report() {
+  std::vector<thread_report_entry> entries = get_thread_report();
+  std::cout << "[Info] thread budget splits: " << entries.size() << std::endl;
+  for (auto& e:entries) {
+    std::cout << "  " << e.phase << ": " << e.jobs << " jobs, budget " << e.budget << " -> " << e.outer
+              << " outer x " << e.per_job << " per job (" << e.count << (e.count == 1 ? " loop)" : " loops)") << std::endl;
+  }
+}
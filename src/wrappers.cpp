@@ -1,10 +1,85 @@
 #include "wrappers.hpp"
 
 #include <iostream>
+#include <algorithm>
+#include <functional>
 
 #include "bounds.hpp"
 #include "lp_bounds.hpp"
 #include "error_check.hpp"
+#include "bound_memo.hpp"
+
+/*
+binom、freq和LP的界经过dist.memo（见bound_memo.hpp），best_LB、best_UB和bound()重复用到同一个界时只算一次
+  LP_LB/LP_UB/LP_bounds不带preset时用normal，备忘录的preset记为"normal"，binom和freq没有preset；
+  samp LB、extended LB依赖划分和攻击结果，不记录
+*/
+static double memoized(dist_t& dist, std::string name, int64_t G, double err, const std::function<double()>& compute) {
+  double value;
+  if (!memo_lookup(dist, name, G, err, "", value)) {
+    value = compute();
+    memo_store(dist, name, G, err, "", value);
+  }
+  return value;
+}
+
+static double memo_binom_LB(dist_t& dist, int64_t G, double err) {
+  return memoized(dist, "binom LB", G, err, [&]() { return binom_LB(dist, G, err); });
+}
+
+static double memo_binom_UB(dist_t& dist, int64_t G, double err) {
+  return memoized(dist, "binom UB", G, err, [&]() { return binom_UB(dist, G, err); });
+}
+
+static double memo_freq_UB(dist_t& dist, int64_t G, double err) {
+  return memoized(dist, "freq UB", G, err, [&]() { return freq_UB(dist, G, err); });
+}
+
+// Gs中LB或UB不在备忘录里的G一起交给LP_bounds（want_lb、want_ub只要一边时只求那一边）
+static void memo_LP(dist_t& dist, std::vector<int64_t>& Gs, double err, bool want_lb, bool want_ub, std::vector<double>& lb, std::vector<double>& ub) {
+  lb.assign(Gs.size(), 0);
+  ub.assign(Gs.size(), 0);
+  std::vector<int64_t> miss, miss_Gs;
+  for (int64_t g=0; g<(int64_t) Gs.size(); ++g) {
+    bool hit_lb = !want_lb || memo_lookup(dist, "LP LB", Gs[g], err, "normal", lb[g]);
+    bool hit_ub = !want_ub || memo_lookup(dist, "LP UB", Gs[g], err, "normal", ub[g]);
+    if (!hit_lb || !hit_ub) {
+      miss.push_back(g);
+      miss_Gs.push_back(Gs[g]);
+    }
+  }
+  if (miss.empty()) {
+    return;
+  }
+
+  std::vector<double> miss_lb, miss_ub;
+  if (want_lb && want_ub) {
+    std::tie(miss_lb, miss_ub) = LP_bounds(dist, miss_Gs, err);
+  }
+  else if (want_lb) {
+    miss_lb = LP_LB(dist, miss_Gs, err);
+  }
+  else {
+    miss_ub = LP_UB(dist, miss_Gs, err);
+  }
+  for (int64_t m=0; m<(int64_t) miss.size(); ++m) {
+    if (want_lb) {
+      lb[miss[m]] = miss_lb.empty() ? -1 : miss_lb[m];
+      memo_store(dist, "LP LB", miss_Gs[m], err, "normal", lb[miss[m]]);
+    }
+    if (want_ub) {
+      ub[miss[m]] = miss_ub.empty() ? -1 : miss_ub[m];
+      memo_store(dist, "LP UB", miss_Gs[m], err, "normal", ub[miss[m]]);
+    }
+  }
+}
+
+static std::pair<double, double> memo_LP(dist_t& dist, int64_t G, double err, bool want_lb, bool want_ub) {
+  std::vector<int64_t> Gs = {G};
+  std::vector<double> lb, ub;
+  memo_LP(dist, Gs, err, want_lb, want_ub, lb, ub);
+  return {lb[0], ub[0]};
+}
 
 double best_LB(dist_t& dist, int64_t G, double err) {
   if (!error_check_basic(dist, G, err)) {
@@ -15,12 +90,12 @@ double best_LB(dist_t& dist, int64_t G, double err) {
     partition(dist, 0.001);
   }
 
-  double lb = binom_LB(dist, G, err);
-  double ub = binom_UB(dist, G, err);
+  double lb = memo_binom_LB(dist, G, err);
+  double ub = memo_binom_UB(dist, G, err);
   double threshold = 0.05;
 
   if (ub - lb > threshold) {
-    double lp_lb = LP_LB(dist, G, err);
+    double lp_lb = memo_LP(dist, G, err, true, false).first;
     if (lp_lb > 0) {
       lb = std::max(lb, lp_lb);
     }
@@ -58,12 +133,12 @@ double best_UB(dist_t& dist, int64_t G, double err) {
     partition(dist, 0.001);
   }
 
-  double lb = binom_LB(dist, G, err);
-  double ub = binom_UB(dist, G, err);
+  double lb = memo_binom_LB(dist, G, err);
+  double ub = memo_binom_UB(dist, G, err);
   double threshold = 0.05;
 
   if (ub - lb > threshold) {
-    double lp_ub = LP_UB(dist, G, err);
+    double lp_ub = memo_LP(dist, G, err, false, true).second;
     if (lp_ub > 0) {
       ub = std::min(ub, lp_ub);
     }
@@ -101,11 +176,12 @@ std::unordered_map<std::string, double> bound(dist_t& dist, int64_t G, double er
   if (dist.model_attack_hits.size() > 0) {
     res["extended LB"] = extended_LB(dist, G, err);
   }
-  res["freq UB"] = freq_UB(dist, G, err);
-  res["LP LB"] = LP_LB(dist, G, err);
-  res["LP UB"] = LP_UB(dist, G, err);
-  res["binom LB"] = binom_LB(dist, G, err);
-  res["binom UB"] = binom_UB(dist, G, err);
+  res["freq UB"] = memo_freq_UB(dist, G, err);
+  auto [lp_lb, lp_ub] = memo_LP(dist, G, err, true, true);
+  res["LP LB"] = lp_lb;
+  res["LP UB"] = lp_ub;
+  res["binom LB"] = memo_binom_LB(dist, G, err);
+  res["binom UB"] = memo_binom_UB(dist, G, err);
 
   return res;
 }
@@ -120,12 +196,12 @@ std::unordered_map<std::string, std::vector<double>> bound(dist_t& dist, std::ve
   for (auto G:Gs) {
     if (dist.D2_idx.size() > 0) res["samp LB"].push_back(samp_LB(dist, G, err));
     if (dist.model_attack_hits.size() > 0) res["extended LB"].push_back(extended_LB(dist, G, err));
-    res["freq UB"].push_back(freq_UB(dist, G, err));
-    res["LP LB"].push_back(LP_LB(dist, G, err));
-    res["LP UB"].push_back(LP_UB(dist, G, err));
-    res["binom LB"].push_back(binom_LB(dist, G, err));
-    res["binom UB"].push_back(binom_UB(dist, G, err));
+    res["freq UB"].push_back(memo_freq_UB(dist, G, err));
+    res["binom LB"].push_back(memo_binom_LB(dist, G, err));
+    res["binom UB"].push_back(memo_binom_UB(dist, G, err));
   }
+  // the LP bounds of all Gs are solved together, LB and UB side by side
+  memo_LP(dist, Gs, err, true, true, res["LP LB"], res["LP UB"]);
 
   return res;
 }
@@ -148,19 +224,24 @@ std::unordered_map<std::string, double> bound(dist_t& dist, int64_t G, double er
     res["extended LB"] = extended_LB(dist, G, err);
   }
   if (in_bounds("freq UB")) {
-    res["freq UB"] = freq_UB(dist, G, err);
+    res["freq UB"] = memo_freq_UB(dist, G, err);
   }
-  if (in_bounds("LP LB")) {
-    res["LP LB"] = LP_LB(dist, G, err);
+  if (in_bounds("LP LB") && in_bounds("LP UB")) {
+    auto [lp_lb, lp_ub] = memo_LP(dist, G, err, true, true);
+    res["LP LB"] = lp_lb;
+    res["LP UB"] = lp_ub;
   }
-  if (in_bounds("LP UB")) {
-    res["LP UB"] = LP_UB(dist, G, err);
+  else if (in_bounds("LP LB")) {
+    res["LP LB"] = memo_LP(dist, G, err, true, false).first;
+  }
+  else if (in_bounds("LP UB")) {
+    res["LP UB"] = memo_LP(dist, G, err, false, true).second;
   }
   if (in_bounds("binom LB")) {
-    res["binom LB"] = binom_LB(dist, G, err);
+    res["binom LB"] = memo_binom_LB(dist, G, err);
   }
   if (in_bounds("binom UB")) {
-    res["binom UB"] = binom_UB(dist, G, err);
+    res["binom UB"] = memo_binom_UB(dist, G, err);
   }
 
   return res;
@@ -208,27 +289,28 @@ std::unordered_map<std::string, std::vector<double>> bound(dist_t& dist, std::ve
   }
   if (in_bounds("freq UB")) {
     for (auto G:Gs) {
-      res["freq UB"].push_back(freq_UB(dist, G, err));
+      res["freq UB"].push_back(memo_freq_UB(dist, G, err));
     }
   }
-  if (in_bounds("LP LB")) {
-    for (auto G:Gs) {
-      res["LP LB"].push_back(LP_LB(dist, G, err));
-    }
+  if (in_bounds("LP LB") && in_bounds("LP UB")) {
+    memo_LP(dist, Gs, err, true, true, res["LP LB"], res["LP UB"]);
   }
-  if (in_bounds("LP UB")) {
-    for (auto G:Gs) {
-      res["LP UB"].push_back(LP_UB(dist, G, err));
-    }
+  else if (in_bounds("LP LB")) {
+    std::vector<double> unused;
+    memo_LP(dist, Gs, err, true, false, res["LP LB"], unused);
+  }
+  else if (in_bounds("LP UB")) {
+    std::vector<double> unused;
+    memo_LP(dist, Gs, err, false, true, unused, res["LP UB"]);
   }
   if (in_bounds("binom LB")) {
     for (auto G:Gs) {
-      res["binom LB"].push_back(binom_LB(dist, G, err));
+      res["binom LB"].push_back(memo_binom_LB(dist, G, err));
     }
   }
   if (in_bounds("binom UB")) {
     for (auto G:Gs) {
-      res["binom UB"].push_back(binom_UB(dist, G, err));
+      res["binom UB"].push_back(memo_binom_UB(dist, G, err));
     }
   }
 